@@ -0,0 +1,489 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "character_dir.h"
+#include "character_tables.h"
+#include "crc32.h"
+#include "font.h"
+#include "font_tag.h"
+#include "glyph_set.h"
+#include "mapped_file.h"
+#include "stats.h"
+#include "tag_writer.h"
+
+#ifdef _WIN32
+    #include <direct.h>
+    #define MKDIR(path, mode) _mkdir(path)
+    #define RMDIR(path) _rmdir(path)
+    #define NULL_REDIRECT ">NUL 2>&1"
+#else
+    #include <unistd.h>
+    #define MKDIR(path, mode) mkdir(path, mode)
+    #define RMDIR(path) rmdir(path)
+    #define NULL_REDIRECT ">/dev/null 2>&1"
+#endif
+
+// Set by CMake to the font-slicer built alongside this
+#ifndef FONT_SLICER_PATH
+    #define FONT_SLICER_PATH "font-slicer"
+#endif
+
+enum bench_glyph_size {
+    BENCH_GLYPHS_SMALL, // latin UI text
+    BENCH_GLYPHS_MIXED, // mostly small, with some large CJK sized glyphs
+    BENCH_GLYPHS_LARGE
+};
+
+struct bench_options {
+    uint32_t characters_count;
+    enum bench_glyph_size glyph_size;
+    bool tables; // give the generated tag character tables
+    bool style_names; // give the generated tag style font names
+    bool crc; // run the crc32 engine benchmark too
+    unsigned jobs; // passed to split and join
+    uint32_t seed;
+    const char *font_slicer;
+    const char *work_dir;
+};
+
+// Same tiny generator every run so results are comparable
+static uint32_t bench_random(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static bool bench_crc32(void) {
+    static const size_t sizes[] = { 20, 4096, 256 * 1024, 32 * 1024 * 1024 };
+    size_t max_size = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+    uint8_t *buffer = malloc(max_size + 1);
+    if(!buffer) {
+        fprintf(stderr, "Could not allocate %zu bytes for benchmark buffer\n", max_size + 1);
+        return false;
+    }
+
+    uint32_t state = 0x12345678;
+    for(size_t i = 0; i < max_size + 1; i++) {
+        buffer[i] = bench_random(&state) & 0xFF;
+    }
+
+    bool success = true;
+    printf("crc32:\n");
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t size = sizes[s];
+
+        // Process about 256 MiB per engine and size, starting one byte in to test unaligned loads
+        size_t rounds = (256 * 1024 * 1024) / size;
+        uint32_t expected = crc32_with_engine(CRC32_ENGINE_BYTEWISE, 0xFFFFFFFF, buffer + 1, size);
+        for(int e = 0; e < CRC32_ENGINE_COUNT; e++) {
+            if(!crc32_engine_available(e)) {
+                continue;
+            }
+
+            uint32_t result = 0;
+            size_t engine_rounds = e == CRC32_ENGINE_BYTEWISE ? rounds / 8 + 1 : rounds;
+            double start = monotonic_seconds();
+            for(size_t r = 0; r < engine_rounds; r++) {
+                result = crc32_with_engine(e, 0xFFFFFFFF, buffer + 1, size);
+            }
+            double elapsed = monotonic_seconds() - start;
+
+            if(result != expected) {
+                fprintf(stderr, "%s gave 0x%08X for %zu bytes, expected 0x%08X\n", crc32_engine_name(e), result, size, expected);
+                success = false;
+            }
+
+            printf("    %-12s %10zu bytes: %8.2f GB/s\n", crc32_engine_name(e), size, (double)size * engine_rounds / elapsed / 1e9);
+        }
+    }
+
+    free(buffer);
+
+    return success;
+}
+
+// Random size for one glyph. About one in twenty is empty, like a space.
+static void bench_glyph_dimensions(enum bench_glyph_size glyph_size, uint32_t *state, int16_t *width, int16_t *height) {
+    bool large = glyph_size == BENCH_GLYPHS_LARGE || (glyph_size == BENCH_GLYPHS_MIXED && bench_random(state) % 8 == 0);
+    if(large) {
+        *width = 24 + bench_random(state) % 25;
+        *height = 24 + bench_random(state) % 25;
+    }
+    else {
+        *width = 4 + bench_random(state) % 9;
+        *height = 8 + bench_random(state) % 9;
+    }
+
+    if(bench_random(state) % 20 == 0) {
+        *width = 0;
+    }
+}
+
+// Write a valid font tag with the same contents for the same options every time
+static bool bench_generate_font_tag(const char *path, const struct bench_options *options, size_t *tag_size) {
+    uint32_t characters_count = options->characters_count;
+    struct font_character *characters = calloc(characters_count, sizeof(struct font_character));
+    uint8_t *character_tables = malloc(CHARACTER_TABLES_MAX_SIZE);
+    uint8_t *pixel_data = nullptr;
+    bool success = false;
+    if(!characters || !character_tables) {
+        fprintf(stderr, "Could not allocate benchmark font\n");
+        goto cleanup;
+    }
+
+    // Pick characters_count different characters, already in order
+    uint32_t state = options->seed;
+    uint32_t needed = characters_count;
+    size_t pixel_data_size = 0;
+    int16_t max_height = 1;
+    for(uint32_t c = 0, i = 0; c <= UINT16_MAX && needed > 0; c++) {
+        if(bench_random(&state) % (UINT16_MAX + 1 - c) >= needed) {
+            continue;
+        }
+
+        int16_t width, height;
+        bench_glyph_dimensions(options->glyph_size, &state, &width, &height);
+        if(height > max_height) {
+            max_height = height;
+        }
+
+        characters[i] = (struct font_character){
+            .character = byteswap16(c),
+            .character_width = byteswap16(width + 1),
+            .bitmap_width = byteswap16(width),
+            .bitmap_height = byteswap16(height),
+            .bitmap_origin_y = byteswap16(height - height / 4),
+            .pixels_offset = byteswap32(pixel_data_size)
+        };
+        pixel_data_size += calculate_pixels_size(width, height);
+        needed--;
+        i++;
+    }
+
+    // Mostly clear with some solid and some partial coverage, roughly like real glyphs
+    pixel_data = malloc(pixel_data_size ? pixel_data_size : 1);
+    if(!pixel_data) {
+        fprintf(stderr, "Could not allocate %zu bytes for benchmark pixel data\n", pixel_data_size);
+        goto cleanup;
+    }
+
+    for(size_t i = 0; i < pixel_data_size; i++) {
+        uint32_t value = bench_random(&state);
+        pixel_data[i] = (value & 3) == 0 ? 0xFF : (value & 3) == 1 ? value >> 24 : 0;
+    }
+
+    uint32_t character_tables_count = 0;
+    size_t character_tables_size = 0;
+    if(options->tables) {
+        character_tables_count = build_character_tables(characters, characters_count, character_tables, &character_tables_size);
+    }
+
+    struct tag_header header = {
+        .tag_group = byteswap32(FONT_SIGNATURE),
+        .offset = byteswap32(sizeof(struct tag_header)),
+        .version = byteswap16(1),
+        .unused_index = 255,
+        .signature = byteswap32(TAG_HEADER_SIGNATURE)
+    };
+
+    struct font_base font = {
+        .ascending_height = byteswap16(max_height),
+        .descending_height = byteswap16(max_height / 4 + 1),
+        .character_tables.count = byteswap32(character_tables_count),
+        .characters.count = byteswap32(characters_count),
+        .pixels.size = byteswap32(pixel_data_size)
+    };
+
+    char style_names[STYLE_FONTS_COUNT][32];
+    for(int i = 0; i < STYLE_FONTS_COUNT; i++) {
+        font.style_fonts[i].tag_group = byteswap32(FONT_SIGNATURE);
+        font.style_fonts[i].index = 0xFFFFFFFF;
+        if(options->style_names) {
+            snprintf(style_names[i], sizeof(style_names[i]), "ui\\bench\\style_%d", i);
+            font.style_fonts[i].name_length = byteswap32(strlen(style_names[i]));
+        }
+    }
+
+    struct tag_writer writer;
+    if(!tag_writer_open(&writer, path, &header)) {
+        goto cleanup;
+    }
+
+    tag_writer_write(&writer, &font, sizeof(font));
+    tag_writer_write(&writer, character_tables, character_tables_size);
+    for(int i = 0; options->style_names && i < STYLE_FONTS_COUNT; i++) {
+        tag_writer_write(&writer, style_names[i], strlen(style_names[i]) + 1);
+    }
+    tag_writer_write(&writer, characters, characters_count * sizeof(struct font_character));
+    tag_writer_write(&writer, pixel_data, pixel_data_size);
+    *tag_size = writer.size;
+    success = tag_writer_close(&writer);
+
+    cleanup:
+    free(characters);
+    free(character_tables);
+    free(pixel_data);
+
+    return success;
+}
+
+// Run font-slicer and time it, with its output thrown away
+static bool bench_run_font_slicer(const struct bench_options *options, const char *command, const char *input, const char *output, double *elapsed) {
+    char command_line[2048];
+#ifdef _WIN32
+    // cmd.exe strips the outer quotes when there are more than two
+    snprintf(command_line, sizeof(command_line), "\"\"%s\" %s --jobs %u \"%s\" \"%s\" " NULL_REDIRECT "\"", options->font_slicer, command, options->jobs, input, output);
+#else
+    snprintf(command_line, sizeof(command_line), "\"%s\" %s --jobs %u \"%s\" \"%s\" " NULL_REDIRECT, options->font_slicer, command, options->jobs, input, output);
+#endif
+
+    double start = monotonic_seconds();
+    int result = system(command_line);
+    *elapsed = monotonic_seconds() - start;
+    if(result != 0) {
+        fprintf(stderr, "%s %s failed (%s)\n", options->font_slicer, command, command_line);
+        return false;
+    }
+
+    return true;
+}
+
+// Delete a directory of character files, and the directory
+static void bench_remove_directory(const char *path) {
+    DIR *d = opendir(path);
+    if(!d) {
+        return;
+    }
+
+    struct dirent *entry;
+    char file_path[1024];
+    while((entry = readdir(d)) != nullptr) {
+        if(strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+            snprintf(file_path, sizeof(file_path), "%s/%s", path, entry->d_name);
+            remove(file_path);
+        }
+    }
+
+    closedir(d);
+    RMDIR(path);
+}
+
+static void bench_print(const char *name, double elapsed, uint32_t glyphs, size_t bytes) {
+    printf("    %-6s %9.3f ms %12.0f glyphs/s", name, elapsed * 1e3, glyphs / elapsed);
+    if(bytes != 0) {
+        printf(" %9.1f MB/s", bytes / elapsed / 1e6);
+    }
+    printf("\n");
+}
+
+// Time converting the tag's characters to and from a glyph set, in process since it is far too quick to time from outside
+static bool bench_glyph_set(const char *tag_path) {
+    struct mapped_file tag_file;
+    if(!mapped_file_open(&tag_file, tag_path)) {
+        return false;
+    }
+
+    struct font_tag_layout tag;
+    struct glyph_set glyphs;
+    struct font_character *characters = nullptr;
+    bool success = false;
+    if(!read_font_tag_layout(tag_path, tag_file.data, tag_file.size, &tag) || !glyph_set_init(&glyphs, tag.characters_count)) {
+        goto cleanup;
+    }
+
+    characters = malloc(tag.characters_count * sizeof(struct font_character));
+    if(!characters) {
+        fprintf(stderr, "Could not allocate characters\n");
+        glyph_set_free(&glyphs);
+        goto cleanup;
+    }
+
+    const int rounds = 100;
+    size_t characters_size = tag.characters_count * sizeof(struct font_character);
+    struct glyph_metrics metrics;
+    double start = monotonic_seconds();
+    for(int r = 0; r < rounds; r++) {
+        glyph_set_decode(&glyphs, tag.characters, tag.characters_count);
+        glyph_set_metrics(&glyphs, &metrics);
+    }
+    bench_print("decode", (monotonic_seconds() - start) / rounds, tag.characters_count, characters_size);
+
+    start = monotonic_seconds();
+    for(int r = 0; r < rounds; r++) {
+        glyph_set_encode(&glyphs, characters);
+    }
+    bench_print("encode", (monotonic_seconds() - start) / rounds, tag.characters_count, characters_size);
+
+    glyph_set_free(&glyphs);
+    success = true;
+
+    cleanup:
+    free(characters);
+    mapped_file_close(&tag_file);
+
+    return success;
+}
+
+// Generate a tag, then decode its characters, split it, scan the split directory and join it back, timing each
+static bool bench_font_slicer(const struct bench_options *options) {
+    static const char *glyph_size_names[] = { "small", "mixed", "large" };
+
+    char tag_path[512], characters_dir[512], joined_path[512];
+    snprintf(tag_path, sizeof(tag_path), "%s/bench.font", options->work_dir);
+    snprintf(characters_dir, sizeof(characters_dir), "%s/characters", options->work_dir);
+    snprintf(joined_path, sizeof(joined_path), "%s/joined.font", options->work_dir);
+
+    struct stat st;
+    if(stat(options->work_dir, &st) == -1 && MKDIR(options->work_dir, 0777) == -1) {
+        fprintf(stderr, "Error creating directory %s\n", options->work_dir);
+        return false;
+    }
+
+    // Left over from a run that was stopped
+    bench_remove_directory(characters_dir);
+
+    size_t tag_size;
+    if(!bench_generate_font_tag(tag_path, options, &tag_size)) {
+        return false;
+    }
+
+    printf("font: %u %s glyphs, %s, %s, %zu bytes, %u jobs\n", options->characters_count, glyph_size_names[options->glyph_size],
+           options->tables ? "character tables" : "no character tables", options->style_names ? "style font names" : "no style font names", tag_size, options->jobs);
+
+    bool success = false;
+    double elapsed;
+    if(!bench_glyph_set(tag_path)) {
+        goto cleanup;
+    }
+
+    if(!bench_run_font_slicer(options, "split", tag_path, characters_dir, &elapsed)) {
+        goto cleanup;
+    }
+    bench_print("split", elapsed, options->characters_count, tag_size);
+
+    // Scanning is fast enough that it needs a few rounds to time
+    uint16_t *character_files = malloc((UINT16_MAX + 1) * sizeof(uint16_t));
+    if(!character_files) {
+        fprintf(stderr, "Could not allocate character file list\n");
+        goto cleanup;
+    }
+
+    const int scan_rounds = 10;
+    int character_files_count = 0;
+    double start = monotonic_seconds();
+    for(int r = 0; r < scan_rounds; r++) {
+        struct character_dir dir;
+        bool scanned = character_dir_open(&dir, characters_dir) && character_dir_scan(&dir, character_files, &character_files_count);
+        character_dir_close(&dir);
+        if(!scanned) {
+            free(character_files);
+            goto cleanup;
+        }
+    }
+    elapsed = (monotonic_seconds() - start) / scan_rounds;
+    free(character_files);
+    bench_print("scan", elapsed, character_files_count, 0);
+
+    if(!bench_run_font_slicer(options, "join", characters_dir, joined_path, &elapsed)) {
+        goto cleanup;
+    }
+    bench_print("join", elapsed, character_files_count, tag_size);
+
+    success = true;
+
+    cleanup:
+    bench_remove_directory(characters_dir);
+    remove(tag_path);
+    remove(joined_path);
+    RMDIR(options->work_dir);
+
+    return success;
+}
+
+static bool parse_number(const char *option, const char *value, unsigned long min, unsigned long max, unsigned long *number) {
+    char *end;
+    if(!value || (*number = strtoul(value, &end, 10)) < min || *number > max || *end != '\0') {
+        fprintf(stderr, "%s needs a number from %lu to %lu\n", option, min, max);
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, const char **argv) {
+    struct bench_options options = {
+        .characters_count = 20000,
+        .glyph_size = BENCH_GLYPHS_MIXED,
+        .crc = true,
+        .jobs = 1,
+        .seed = 0x12345678,
+        .font_slicer = FONT_SLICER_PATH,
+        .work_dir = "font-slicer-bench.tmp"
+    };
+
+    for(int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        unsigned long number;
+        if(strcmp(arg, "--characters") == 0 && parse_number(arg, value, 1, UINT16_MAX, &number)) {
+            options.characters_count = number;
+            i++;
+        }
+        else if(strcmp(arg, "--jobs") == 0 && parse_number(arg, value, 1, 256, &number)) {
+            options.jobs = number;
+            i++;
+        }
+        else if(strcmp(arg, "--seed") == 0 && parse_number(arg, value, 1, UINT32_MAX, &number)) {
+            options.seed = number;
+            i++;
+        }
+        else if(strcmp(arg, "--glyphs") == 0 && value && (strcmp(value, "small") == 0 || strcmp(value, "mixed") == 0 || strcmp(value, "large") == 0)) {
+            options.glyph_size = value[0] == 's' ? BENCH_GLYPHS_SMALL : value[0] == 'm' ? BENCH_GLYPHS_MIXED : BENCH_GLYPHS_LARGE;
+            i++;
+        }
+        else if(strcmp(arg, "--font-slicer") == 0 && value) {
+            options.font_slicer = value;
+            i++;
+        }
+        else if(strcmp(arg, "--work-dir") == 0 && value) {
+            options.work_dir = value;
+            i++;
+        }
+        else if(strcmp(arg, "--tables") == 0) {
+            options.tables = true;
+        }
+        else if(strcmp(arg, "--style-names") == 0) {
+            options.style_names = true;
+        }
+        else if(strcmp(arg, "--no-crc") == 0) {
+            options.crc = false;
+        }
+        else {
+            printf("Usage: %s [options]\nOptions:\n"
+                   "    --characters <n>      characters in the generated font, 1-65535 (default 20000)\n"
+                   "    --glyphs <size>       small, mixed or large glyphs (default mixed)\n"
+                   "    --tables              give the generated font character tables\n"
+                   "    --style-names         give the generated font style font names\n"
+                   "    --seed <n>            generate a different font\n"
+                   "    --jobs <n>            passed to split and join (default 1)\n"
+                   "    --font-slicer <path>  font-slicer to time (default %s)\n"
+                   "    --work-dir <path>     where to put the generated files, removed afterwards (default font-slicer-bench.tmp)\n"
+                   "    --no-crc              skip the crc32 benchmark\n", argv[0], FONT_SLICER_PATH);
+            return 1;
+        }
+    }
+
+    bool success = bench_font_slicer(&options);
+    if(options.crc) {
+        success = bench_crc32() && success;
+    }
+
+    return success ? 0 : 1;
+}
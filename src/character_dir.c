@@ -0,0 +1,257 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+#include "character_dir.h"
+#include "character_rle.h"
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+// Longest valid name is "65535.binz"
+#define CHARACTER_FILE_NAME_MAX 10
+
+bool character_dir_open(struct character_dir *dir, const char *path) {
+    *dir = (struct character_dir){ .path = path };
+    dir->dir = opendir(path);
+    if(!dir->dir) {
+        fprintf(stderr, "Could not open directory %s\n", path);
+        return false;
+    }
+
+    return true;
+}
+
+void character_dir_close(struct character_dir *dir) {
+    if(dir->dir) {
+        closedir(dir->dir);
+    }
+
+    *dir = (struct character_dir){0};
+}
+
+bool parse_character_file_name(const char *name, size_t name_length, uint32_t *character, bool *compressed) {
+    uint32_t value = 0;
+    size_t digits = 0;
+    while(digits < name_length && name[digits] >= '0' && name[digits] <= '9') {
+        // Anything past the largest character stays past it instead of wrapping around
+        if(value <= UINT16_MAX) {
+            value = value * 10 + (name[digits] - '0');
+        }
+        digits++;
+    }
+
+    size_t extension_length = name_length - digits;
+    if(digits == 0 || (extension_length != 4 && extension_length != 5) || memcmp(name + digits, ".binz", extension_length) != 0) {
+        return false;
+    }
+
+    *character = value;
+    *compressed = extension_length == 5;
+
+    return true;
+}
+
+bool character_dir_scan(struct character_dir *dir, uint16_t *character_files, int *count) {
+    // One bit per character. Setting a bit twice means a duplicate, and reading them back in order gives a sorted list
+    uint64_t present[(UINT16_MAX + 1) / 64] = {0};
+    int character_files_count = 0;
+
+    struct dirent *entry;
+    while((entry = readdir(dir->dir)) != nullptr) {
+        const char *name = entry->d_name;
+
+        // Exclude "." and ".."
+        if(name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+
+        size_t name_length = strlen(name);
+        if(name_length > CHARACTER_FILE_NAME_MAX) {
+            fprintf(stderr, "%s has too long of a name to be a valid character file\n", name);
+            return false;
+        }
+
+        uint32_t character;
+        bool compressed;
+        if(!parse_character_file_name(name, name_length, &character, &compressed)) {
+            fprintf(stderr, "%s is not named with format <character number>.bin\n", name);
+            return false;
+        }
+
+        if(character > UINT16_MAX) {
+            fprintf(stderr, "%s is out of bounds to be a valid font character (must be 0-65535)\n", name);
+            return false;
+        }
+
+        uint64_t bit = (uint64_t)1 << (character % 64);
+        if(present[character / 64] & bit) {
+            fprintf(stderr, "%s is not the only file for character %u\n", name, character);
+            return false;
+        }
+
+        // A tag counts its characters in 16 bits, so one file for every character is one too many
+        if(character_files_count == UINT16_MAX) {
+            fprintf(stderr, "%s has too many character files to be a valid font tag (must be at most %u)\n", dir->path, UINT16_MAX);
+            return false;
+        }
+
+        present[character / 64] |= bit;
+        if(compressed) {
+            dir->compressed[character / 64] |= bit;
+        }
+        character_files_count++;
+    }
+
+    // Nothing to do if there are no characters
+    if(character_files_count == 0) {
+        fprintf(stderr, "No valid font characters were found in %s\n", dir->path);
+        return false;
+    }
+
+    // Font characters should be stored from lowest to highest
+    uint32_t i = 0;
+    for(uint32_t word = 0; word < sizeof(present) / sizeof(present[0]); word++) {
+        uint64_t bits = present[word];
+        for(uint32_t bit_index = 0; bits != 0; bit_index++, bits >>= 1) {
+            if(bits & 1) {
+                character_files[i++] = word * 64 + bit_index;
+            }
+        }
+    }
+
+    *count = character_files_count;
+
+    return true;
+}
+
+static bool character_dir_is_compressed(const struct character_dir *dir, uint16_t character) {
+    return (dir->compressed[character / 64] >> (character % 64)) & 1;
+}
+
+// Name of a character's file in the directory
+static void character_file_name(const struct character_dir *dir, uint16_t character, char *buffer, size_t buffer_size) {
+    snprintf(buffer, buffer_size, "%u.%s", character, character_dir_is_compressed(dir, character) ? "binz" : "bin");
+}
+
+void character_dir_file_path(const struct character_dir *dir, uint16_t character, char *buffer, size_t buffer_size) {
+    char name[CHARACTER_FILE_NAME_MAX + 1];
+    character_file_name(dir, character, name, sizeof(name));
+    snprintf(buffer, buffer_size, "%s/%s", dir->path, name);
+}
+
+int character_dir_stat(const struct character_dir *dir, uint16_t character, struct stat *st) {
+#ifdef _WIN32
+    char path[512];
+    character_dir_file_path(dir, character, path, sizeof(path));
+    return stat(path, st);
+#else
+    char name[CHARACTER_FILE_NAME_MAX + 1];
+    character_file_name(dir, character, name, sizeof(name));
+    return fstatat(dirfd(dir->dir), name, st, 0);
+#endif
+}
+
+static bool read_at(int fd, void *data, size_t size, size_t offset) {
+    uint8_t *cursor = data;
+#ifdef _WIN32
+    if(lseek(fd, offset, SEEK_SET) != (long)offset) {
+        return false;
+    }
+#endif
+
+    while(size > 0) {
+#ifdef _WIN32
+        int result = read(fd, cursor, size > INT32_MAX ? INT32_MAX : (unsigned)size);
+#else
+        ssize_t result = pread(fd, cursor, size, offset);
+#endif
+        if(result <= 0) {
+            return false;
+        }
+
+        cursor += result;
+        offset += result;
+        size -= result;
+    }
+
+    return true;
+}
+
+bool character_file_open(const struct character_dir *dir, uint16_t character, struct character_file *file) {
+    char path[512];
+#ifdef _WIN32
+    character_dir_file_path(dir, character, path, sizeof(path));
+    int fd = open(path, O_RDONLY | O_BINARY);
+#else
+    char name[CHARACTER_FILE_NAME_MAX + 1];
+    character_file_name(dir, character, name, sizeof(name));
+    int fd = openat(dirfd(dir->dir), name, O_RDONLY);
+#endif
+    struct stat st;
+    if(fd == -1 || fstat(fd, &st) != 0) {
+        character_dir_file_path(dir, character, path, sizeof(path));
+        fprintf(stderr, "Failed to open %s\n", path);
+        if(fd != -1) {
+            close(fd);
+        }
+        return false;
+    }
+
+    *file = (struct character_file){
+        .fd = fd,
+        .compressed = character_dir_is_compressed(dir, character),
+        .file_size = st.st_size,
+        .size = st.st_size
+    };
+
+    if(file->compressed) {
+        struct character_rle_header header;
+        if(file->file_size < sizeof(header) || !read_at(fd, &header, sizeof(header), 0) || !character_rle_header_valid(&header)) {
+            character_dir_file_path(dir, character, path, sizeof(path));
+            fprintf(stderr, "%s is not a valid compressed character file\n", path);
+            character_file_close(file);
+            return false;
+        }
+
+        file->size = byteswap32(header.size);
+        file->character = header.character;
+    }
+
+    return true;
+}
+
+bool character_file_read_character(const struct character_file *file, struct font_character *character) {
+    if(file->compressed) {
+        *character = file->character;
+        return true;
+    }
+
+    return read_at(file->fd, character, sizeof(*character), 0);
+}
+
+bool character_file_read_pixels(const struct character_file *file, uint8_t *pixels, size_t pixels_size) {
+    if(!file->compressed) {
+        return read_at(file->fd, pixels, pixels_size, sizeof(struct font_character));
+    }
+
+    size_t data_size = file->file_size - sizeof(struct character_rle_header);
+    uint8_t *data = malloc(data_size ? data_size : 1);
+    bool success = data && read_at(file->fd, data, data_size, sizeof(struct character_rle_header)) &&
+                   character_rle_decode(data, data_size, pixels, pixels_size);
+    free(data);
+
+    return success;
+}
+
+void character_file_close(struct character_file *file) {
+    close(file->fd);
+    file->fd = -1;
+}
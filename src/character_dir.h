@@ -0,0 +1,53 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "font.h"
+
+// A directory of <character>.bin files, any of which can be a <character>.binz compressed with character_rle instead.
+// It stays open while it is used, so files in it are opened relative to it instead of resolving the whole path each
+// time (except on Windows).
+struct character_dir {
+    const char *path;
+    DIR *dir;
+    uint64_t compressed[(UINT16_MAX + 1) / 64]; // one bit per character whose file is a .binz, set by character_dir_scan
+};
+
+bool character_dir_open(struct character_dir *dir, const char *path);
+void character_dir_close(struct character_dir *dir);
+
+// Parse <number>.bin or <number>.binz. Leading zeros are fine, anything else isn't. The number is not checked against
+// the largest character.
+bool parse_character_file_name(const char *name, size_t name_length, uint32_t *character, bool *compressed);
+
+// List the characters that have a file, lowest first. character_files must hold 65536 entries.
+// Fails on a badly named file, on two files for the same character (a .bin and a .binz count), or if there are none.
+bool character_dir_scan(struct character_dir *dir, uint16_t *character_files, int *count);
+
+// Path of a character's file, for messages
+void character_dir_file_path(const struct character_dir *dir, uint16_t character, char *buffer, size_t buffer_size);
+
+int character_dir_stat(const struct character_dir *dir, uint16_t character, struct stat *st);
+
+// A character file opened for reading. A compressed file's header is read when it is opened.
+struct character_file {
+    int fd;
+    bool compressed;
+    size_t file_size; // on disk
+    size_t size; // what it holds once decompressed: the character struct and its pixels
+    struct font_character character; // from the header of a compressed file
+};
+
+// Open a character's file and get its size. Prints why and fails if it can't be opened, or if it is compressed and
+// its header is not valid.
+bool character_file_open(const struct character_dir *dir, uint16_t character, struct character_file *file);
+bool character_file_read_character(const struct character_file *file, struct font_character *character);
+
+// Read the pixels after the character struct. A compressed file has to decode to exactly pixels_size bytes.
+bool character_file_read_pixels(const struct character_file *file, uint8_t *pixels, size_t pixels_size);
+void character_file_close(struct character_file *file);
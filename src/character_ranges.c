@@ -0,0 +1,97 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "character_ranges.h"
+
+// Parse one character at text, which is decimal unless it starts with 0x or U+. Returns where it ends, or null.
+static const char *parse_character(const char *text, uint32_t *character) {
+    unsigned base = 10;
+    if((text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) || ((text[0] == 'U' || text[0] == 'u') && text[1] == '+')) {
+        base = 16;
+        text += 2;
+    }
+
+    uint32_t value = 0;
+    const char *start = text;
+    for(; *text; text++) {
+        unsigned digit;
+        if(*text >= '0' && *text <= '9') {
+            digit = *text - '0';
+        }
+        else if(base == 16 && *text >= 'a' && *text <= 'f') {
+            digit = *text - 'a' + 10;
+        }
+        else if(base == 16 && *text >= 'A' && *text <= 'F') {
+            digit = *text - 'A' + 10;
+        }
+        else {
+            break;
+        }
+
+        value = value * base + digit;
+        if(value > UINT16_MAX) {
+            return nullptr;
+        }
+    }
+
+    *character = value;
+    return text == start ? nullptr : text;
+}
+
+bool character_ranges_parse(const char *option, const char *text, bool allow_ranges, struct character_ranges *ranges) {
+    const char *p = text;
+    do {
+        uint32_t first;
+        uint32_t last;
+        p = parse_character(p, &first);
+        last = first;
+        if(p && *p == '-' && allow_ranges) {
+            p = parse_character(p + 1, &last);
+        }
+
+        if(!p || (*p != ',' && *p != '\0') || last < first) {
+            if(allow_ranges) {
+                fprintf(stderr, "%s needs characters or ranges of characters from 0 to 0xFFFF, like 0x2000-0x206F,65 (not %s)\n", option, text);
+            }
+            else {
+                fprintf(stderr, "%s needs characters from 0 to 0xFFFF, like 0x2190,65 (not %s)\n", option, text);
+            }
+            return false;
+        }
+
+        if(ranges) {
+            for(uint32_t c = first; c <= last; c++) {
+                ranges->bits[c / 64] |= (uint64_t)1 << (c % 64);
+            }
+        }
+    } while(*p++ == ',');
+
+    return true;
+}
+
+void character_ranges_print(FILE *file, const struct character_ranges *ranges) {
+    uint32_t printed = 0;
+    for(uint32_t character = 0; character <= UINT16_MAX; character++) {
+        if(!character_ranges_contains(ranges, character)) {
+            continue;
+        }
+
+        if(printed == 8) {
+            fprintf(file, ",...");
+            return;
+        }
+
+        uint32_t last = character;
+        while(last < UINT16_MAX && character_ranges_contains(ranges, last + 1)) {
+            last++;
+        }
+
+        fprintf(file, printed++ ? ",0x%04X" : "0x%04X", character);
+        if(last != character) {
+            fprintf(file, "-0x%04X", last);
+        }
+        character = last;
+    }
+}
@@ -0,0 +1,24 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// A set of characters. On the command line it is a comma separated list of characters and inclusive ranges,
+// each in decimal or hex: 0x2000-0x206F,65,U+3000-U+303F
+struct character_ranges {
+    uint64_t bits[(UINT16_MAX + 1) / 64];
+};
+
+// Parse a list and add what is in it to ranges. Without allow_ranges the list can only have single characters.
+// ranges can be null to only check the list. option is only used in messages.
+bool character_ranges_parse(const char *option, const char *text, bool allow_ranges, struct character_ranges *ranges);
+
+static inline bool character_ranges_contains(const struct character_ranges *ranges, uint16_t character) {
+    return (ranges->bits[character / 64] >> (character % 64)) & 1;
+}
+
+// Print ranges the way they are written, like 0x41,0x2000-0x206F. Only the first few are printed if there are many.
+void character_ranges_print(FILE *file, const struct character_ranges *ranges);
@@ -0,0 +1,72 @@
+// Font Slicer, by Aerocatia
+
+#include <stdint.h>
+#include <string.h>
+
+#include "character_rle.h"
+
+// Each block starts with a byte saying what it is. Below 0x80, that many plus one bytes are copied as they are.
+// From 0x80, the next byte is repeated that many minus 0x80 plus three times. Shorter runs are cheaper to copy.
+#define RLE_MAX_LITERAL 128
+#define RLE_MIN_RUN 3
+#define RLE_MAX_RUN (0x7F + RLE_MIN_RUN)
+
+size_t character_rle_encode(const uint8_t *pixels, size_t pixels_size, uint8_t *out) {
+    size_t out_size = 0;
+    size_t i = 0;
+    while(i < pixels_size) {
+        size_t run = 1;
+        while(i + run < pixels_size && run < RLE_MAX_RUN && pixels[i + run] == pixels[i]) {
+            run++;
+        }
+
+        if(run >= RLE_MIN_RUN) {
+            out[out_size++] = 0x80 + (run - RLE_MIN_RUN);
+            out[out_size++] = pixels[i];
+            i += run;
+            continue;
+        }
+
+        // Copy up to where the next run starts
+        size_t start = i;
+        while(i < pixels_size && i - start < RLE_MAX_LITERAL) {
+            if(i + 2 < pixels_size && pixels[i] == pixels[i + 1] && pixels[i] == pixels[i + 2]) {
+                break;
+            }
+            i++;
+        }
+
+        out[out_size++] = i - start - 1;
+        memcpy(out + out_size, pixels + start, i - start);
+        out_size += i - start;
+    }
+
+    return out_size;
+}
+
+bool character_rle_decode(const uint8_t *data, size_t data_size, uint8_t *pixels, size_t pixels_size) {
+    size_t in = 0;
+    size_t out = 0;
+    while(in < data_size) {
+        uint8_t block = data[in++];
+        if(block < 0x80) {
+            size_t count = block + 1;
+            if(data_size - in < count || pixels_size - out < count) {
+                return false;
+            }
+            memcpy(pixels + out, data + in, count);
+            in += count;
+            out += count;
+        }
+        else {
+            size_t count = block - 0x80 + RLE_MIN_RUN;
+            if(in == data_size || pixels_size - out < count) {
+                return false;
+            }
+            memset(pixels + out, data[in++], count);
+            out += count;
+        }
+    }
+
+    return out == pixels_size;
+}
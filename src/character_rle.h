@@ -0,0 +1,46 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "font.h"
+
+// A compressed character file (<character>.binz):
+//   header, run length encoded pixel data
+// The header is big endian and keeps the character struct as it is in a .bin, so its metrics can still be read
+// without decoding anything. Bitmaps are mostly long runs of the same intensity, usually zero, so they shrink a lot.
+enum {
+    CHARACTER_RLE_SIGNATURE = 0x62696E7A, // 'binz'
+    CHARACTER_RLE_VERSION = 1
+};
+
+struct character_rle_header {
+    uint32_t signature;
+    uint16_t version;
+    char pad[2];
+    uint32_t size; // size of the .bin this was made from, character struct included
+    struct font_character character;
+};
+static_assert(sizeof(struct character_rle_header) == 32);
+
+static inline bool character_rle_header_valid(const struct character_rle_header *header) {
+    return byteswap32(header->signature) == CHARACTER_RLE_SIGNATURE && byteswap16(header->version) == CHARACTER_RLE_VERSION;
+}
+
+// Most bytes encoding pixels_size bytes can take
+static inline size_t character_rle_bound(size_t pixels_size) {
+    return pixels_size + pixels_size / 128 + 1;
+}
+
+// Most bytes any data decoding to exactly pixels_size bytes can take, which is a one byte block for every byte
+static inline size_t character_rle_max_size(size_t pixels_size) {
+    return pixels_size * 2;
+}
+
+// Encode pixels into out, which must hold character_rle_bound(pixels_size) bytes. Returns the encoded size.
+size_t character_rle_encode(const uint8_t *pixels, size_t pixels_size, uint8_t *out);
+
+// Decode exactly pixels_size bytes. Fails if data runs out first, would decode to more, or has anything left over.
+bool character_rle_decode(const uint8_t *data, size_t data_size, uint8_t *pixels, size_t pixels_size);
@@ -0,0 +1,47 @@
+// Font Slicer, by Aerocatia
+
+#include <stdint.h>
+#include <string.h>
+
+#include "character_tables.h"
+
+uint32_t build_character_tables(const struct font_character *characters, uint32_t characters_count, uint8_t *buffer, size_t *size) {
+    // Find which high bytes are used. The last one used decides how many tables there are
+    bool used[CHARACTER_TABLES_MAX_COUNT] = {0};
+    uint32_t tables_count = 0;
+    for(uint32_t i = 0; i < characters_count; i++) {
+        uint16_t high = byteswap16(characters[i].character) >> 8;
+        used[high] = true;
+        if(high >= tables_count) {
+            tables_count = high + 1;
+        }
+    }
+
+    // Entries first, with each used table's contents following in order
+    struct font_character_tables_entry *entries = (struct font_character_tables_entry *)buffer;
+    uint16_t *tables[CHARACTER_TABLES_MAX_COUNT];
+    uint16_t *table_cursor = (uint16_t *)(buffer + tables_count * sizeof(struct font_character_tables_entry));
+    for(uint32_t t = 0; t < tables_count; t++) {
+        entries[t] = (struct font_character_tables_entry){0};
+        if(used[t]) {
+            entries[t].table.count = byteswap32(CHARACTER_TABLE_SIZE);
+            tables[t] = table_cursor;
+            table_cursor += CHARACTER_TABLE_SIZE;
+        }
+    }
+
+    // 0xFFFF is the same either way round
+    uint16_t *tables_start = (uint16_t *)(buffer + tables_count * sizeof(struct font_character_tables_entry));
+    memset(tables_start, 0xFF, (table_cursor - tables_start) * sizeof(uint16_t));
+    for(uint32_t i = 0; i < characters_count; i++) {
+        uint16_t character = byteswap16(characters[i].character);
+        uint16_t *slot = &tables[character >> 8][character & 0xFF];
+        if(*slot == CHARACTER_TABLE_EMPTY) {
+            *slot = byteswap16(i);
+        }
+    }
+
+    *size = (uint8_t *)table_cursor - buffer;
+
+    return tables_count;
+}
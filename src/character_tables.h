@@ -0,0 +1,21 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "font.h"
+
+// The engine finds a character's index with tables[character >> 8][character & 0xFF]
+#define CHARACTER_TABLES_MAX_COUNT 256
+#define CHARACTER_TABLE_SIZE 256
+#define CHARACTER_TABLE_EMPTY 0xFFFF
+
+// Most space the tables can take: an entry and a full table for every high byte
+#define CHARACTER_TABLES_MAX_SIZE (CHARACTER_TABLES_MAX_COUNT * (sizeof(struct font_character_tables_entry) + CHARACTER_TABLE_SIZE * sizeof(struct font_character_table_entry)))
+
+// Build the character tables for a character array as they are laid out in a tag: the table entries, then the
+// contents of each table. High bytes with no characters get an empty table. If a character appears twice, the first wins.
+// buffer must hold CHARACTER_TABLES_MAX_SIZE bytes. Returns the number of tables and sets size to the bytes used.
+uint32_t build_character_tables(const struct font_character *characters, uint32_t characters_count, uint8_t *buffer, size_t *size);
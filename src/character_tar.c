@@ -0,0 +1,201 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "character_dir.h"
+#include "character_tar.h"
+
+static const uint8_t zero_block[CHARACTER_TAR_BLOCK_SIZE];
+
+// The checksum is the sum of every byte of the header, counting the checksum field itself as spaces
+static unsigned header_checksum(const struct character_tar_header *header) {
+    const uint8_t *bytes = (const uint8_t *)header;
+    unsigned checksum = 0;
+    for(size_t i = 0; i < sizeof(*header); i++) {
+        checksum += i >= offsetof(struct character_tar_header, checksum) && i < offsetof(struct character_tar_header, type) ? ' ' : bytes[i];
+    }
+
+    return checksum;
+}
+
+size_t character_tar_write(FILE *file, const struct font_character *character, const uint8_t *pixels, size_t pixels_size) {
+    size_t file_size = sizeof(struct font_character) + pixels_size;
+
+    struct character_tar_header header = {0};
+    snprintf(header.name, sizeof(header.name), "%u.bin", byteswap16(character->character));
+    memcpy(header.mode, "0000644", 8);
+    memcpy(header.uid, "0000000", 8);
+    memcpy(header.gid, "0000000", 8);
+    snprintf(header.size, sizeof(header.size), "%011llo", (unsigned long long)file_size);
+    memcpy(header.mtime, "00000000000", 12);
+    header.type = '0';
+    memcpy(header.magic, "ustar", 6);
+    memcpy(header.version, "00", 2);
+    snprintf(header.checksum, sizeof(header.checksum), "%06o", header_checksum(&header));
+    header.checksum[7] = ' ';
+
+    // Same as a file from split: the stale pixel data offset is cleared
+    struct font_character character_out = *character;
+    character_out.pixels_offset = 0;
+
+    size_t padding = (CHARACTER_TAR_BLOCK_SIZE - file_size % CHARACTER_TAR_BLOCK_SIZE) % CHARACTER_TAR_BLOCK_SIZE;
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(&character_out, sizeof(character_out), 1, file) == 1 &&
+                   (pixels_size == 0 || fwrite(pixels, pixels_size, 1, file) == 1) && (padding == 0 || fwrite(zero_block, padding, 1, file) == 1);
+
+    return success ? sizeof(header) + file_size + padding : 0;
+}
+
+bool character_tar_end(FILE *file) {
+    return fwrite(zero_block, sizeof(zero_block), 1, file) == 1 && fwrite(zero_block, sizeof(zero_block), 1, file) == 1;
+}
+
+// Numeric fields are octal, optionally padded with spaces in front and ended by a space or null
+static bool parse_octal(const char *field, size_t field_size, uint64_t *value) {
+    size_t i = 0;
+    while(i < field_size && field[i] == ' ') {
+        i++;
+    }
+
+    uint64_t result = 0;
+    size_t digits = 0;
+    for(; i < field_size && field[i] >= '0' && field[i] <= '7'; i++, digits++) {
+        if(result >> 61) {
+            return false;
+        }
+        result = result * 8 + (field[i] - '0');
+    }
+
+    if(digits == 0 || (i < field_size && field[i] != ' ' && field[i] != '\0')) {
+        return false;
+    }
+
+    *value = result;
+
+    return true;
+}
+
+// Stdin can't seek, so skipping means reading
+static bool skip_bytes(FILE *file, uint64_t size) {
+    uint8_t buffer[CHARACTER_TAR_BLOCK_SIZE * 8];
+    while(size > 0) {
+        size_t chunk = size < sizeof(buffer) ? size : sizeof(buffer);
+        if(fread(buffer, chunk, 1, file) != 1) {
+            return false;
+        }
+        size -= chunk;
+    }
+
+    return true;
+}
+
+static uint64_t padding_size(uint64_t size) {
+    return (CHARACTER_TAR_BLOCK_SIZE - size % CHARACTER_TAR_BLOCK_SIZE) % CHARACTER_TAR_BLOCK_SIZE;
+}
+
+bool character_tar_next(FILE *file, struct character_tar_entry *entry, bool *end) {
+    *end = false;
+    while(true) {
+        struct character_tar_header header;
+        size_t read = fread(&header, 1, sizeof(header), file);
+
+        // An archive is meant to end with empty blocks, but one that just stops between files is fine too
+        if(read == 0 && feof(file)) {
+            *end = true;
+            return true;
+        }
+        if(read != sizeof(header)) {
+            fprintf(stderr, "Archive ends in the middle of a file header\n");
+            return false;
+        }
+        if(memcmp(&header, zero_block, sizeof(header)) == 0) {
+            *end = true;
+            return true;
+        }
+
+        uint64_t checksum;
+        if(!parse_octal(header.checksum, sizeof(header.checksum), &checksum) || checksum != header_checksum(&header)) {
+            fprintf(stderr, "Archive has a file header with a bad checksum\n");
+            return false;
+        }
+
+        // Only POSIX archives have a prefix. GNU ones keep other things there.
+        if(header.prefix[0] != '\0' && memcmp(header.magic, "ustar", 6) == 0) {
+            snprintf(entry->name, sizeof(entry->name), "%.*s/%.*s", (int)sizeof(header.prefix), header.prefix, (int)sizeof(header.name), header.name);
+        }
+        else {
+            snprintf(entry->name, sizeof(entry->name), "%.*s", (int)sizeof(header.name), header.name);
+        }
+
+        uint64_t size;
+        if(!parse_octal(header.size, sizeof(header.size), &size)) {
+            fprintf(stderr, "%s has a bad size in the archive\n", entry->name);
+            return false;
+        }
+
+        switch(header.type) {
+            // Regular files
+            case '0':
+            case '\0':
+            case '7':
+                break;
+
+            // Directories, pax headers and GNU long names
+            case '5':
+            case 'g':
+            case 'x':
+            case 'K':
+            case 'L':
+                if(!skip_bytes(file, size + padding_size(size))) {
+                    fprintf(stderr, "Archive ends in the middle of %s\n", entry->name);
+                    return false;
+                }
+                continue;
+
+            default:
+                fprintf(stderr, "%s is not a regular file\n", entry->name);
+                return false;
+        }
+
+        const char *slash = strrchr(entry->name, '/');
+        const char *name = slash ? slash + 1 : entry->name;
+        uint32_t character;
+        if(!parse_character_file_name(name, strlen(name), &character, &entry->compressed)) {
+            fprintf(stderr, "%s is not named with format <character number>.bin or <character number>.binz\n", entry->name);
+            return false;
+        }
+
+        if(character > UINT16_MAX) {
+            fprintf(stderr, "%s is out of bounds to be a valid font character (must be 0-65535)\n", entry->name);
+            return false;
+        }
+
+        if(size > SIZE_MAX) {
+            fprintf(stderr, "%s is too big\n", entry->name);
+            return false;
+        }
+
+        entry->character = character;
+        entry->size = size;
+        entry->read = 0;
+
+        return true;
+    }
+}
+
+bool character_tar_read(FILE *file, struct character_tar_entry *entry, void *data, size_t size) {
+    if(size > entry->size - entry->read || (size != 0 && fread(data, size, 1, file) != 1)) {
+        fprintf(stderr, "Archive ends in the middle of %s\n", entry->name);
+        return false;
+    }
+
+    // Only the read that finishes the file skips the padding, not an empty one after it
+    entry->read += size;
+    if(size != 0 && entry->read == entry->size && !skip_bytes(file, padding_size(entry->size))) {
+        fprintf(stderr, "Archive ends in the middle of %s\n", entry->name);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,60 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "font.h"
+
+// Character files as a ustar archive, named and laid out exactly like a split directory, so a split can be piped
+// somewhere instead of written out file by file. Unpacking it with tar gives the same directory split would have made,
+// and join can read one back from a pipe the same way.
+#define CHARACTER_TAR_BLOCK_SIZE 512
+
+struct character_tar_header {
+    char name[100];
+    char mode[8];
+    char uid[8];
+    char gid[8];
+    char size[12];
+    char mtime[12];
+    char checksum[8];
+    char type;
+    char link_name[100];
+    char magic[6];
+    char version[2];
+    char user_name[32];
+    char group_name[32];
+    char device_major[8];
+    char device_minor[8];
+    char prefix[155];
+    char pad[12];
+};
+static_assert(sizeof(struct character_tar_header) == CHARACTER_TAR_BLOCK_SIZE);
+
+// Write <character>.bin with a character and its pixels. Everything the archive holds is the same each time, including
+// the file times, so the same tag always gives the same archive. Returns the number of bytes written, or 0 on failure.
+size_t character_tar_write(FILE *file, const struct font_character *character, const uint8_t *pixels, size_t pixels_size);
+
+// Write the two empty blocks that end an archive
+bool character_tar_end(FILE *file);
+
+// A character file found in an archive
+struct character_tar_entry {
+    char name[256]; // path in the archive, for messages
+    uint16_t character;
+    bool compressed; // a .binz
+    size_t size;
+    size_t read; // how much of it character_tar_read has read so far
+};
+
+// Read up to the next character file, skipping directories and the extra headers tar can add. Whatever directory the file
+// is in is ignored, so an archive of a split directory made by tar works as well as one from split. Fails on any other
+// file that isn't named <character>.bin or <character>.binz, like joining a directory would. Sets end instead once the archive is done.
+bool character_tar_next(FILE *file, struct character_tar_entry *entry, bool *end);
+
+// Read the next size bytes of the file that character_tar_next found, so its character struct can be checked before
+// anything is allocated for the rest. The padding after the file is skipped once all entry->size bytes are read.
+bool character_tar_read(FILE *file, struct character_tar_entry *entry, void *data, size_t size);
@@ -0,0 +1,308 @@
+// Font Slicer, by Aerocatia
+
+#include <stdint.h>
+#include <stddef.h>
+#include <threads.h>
+
+#include "crc32.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define CRC32_HAVE_PCLMUL
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define CRC32_TARGET_PCLMUL
+    #else
+        #define CRC32_TARGET_PCLMUL __attribute__((target("pclmul,sse4.1")))
+    #endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+    #define CRC32_HAVE_ARMV8
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #include <windows.h>
+        #define CRC32_TARGET_ARMV8
+    #else
+        #include <arm_acle.h>
+        #define CRC32_TARGET_ARMV8 __attribute__((target("+crc")))
+        #if defined(__linux__) && !defined(__ARM_FEATURE_CRC32)
+            #include <sys/auxv.h>
+            #include <asm/hwcap.h>
+        #endif
+    #endif
+#endif
+
+/*
+ *  CRC code COPYRIGHT (C) 1986 Gary S. Brown.  You may use this program, or
+ *  code or tables extracted from it, as desired without restriction.
+ */
+
+// CRC is linear, so each slicing table entry is the XOR of the entries for the bits set in its index.
+// Only those 8 values are written out per table; the preprocessor expands the other 248.
+// Table k gives the CRC of a byte followed by k zero bytes. Table 0 is the classic byte-at-a-time table.
+#define CRC32_ENTRY(n, b0, b1, b2, b3, b4, b5, b6, b7) ( \
+    ((n) & 0x01 ? b0 : 0) ^ ((n) & 0x02 ? b1 : 0) ^ ((n) & 0x04 ? b2 : 0) ^ ((n) & 0x08 ? b3 : 0) ^ \
+    ((n) & 0x10 ? b4 : 0) ^ ((n) & 0x20 ? b5 : 0) ^ ((n) & 0x40 ? b6 : 0) ^ ((n) & 0x80 ? b7 : 0))
+#define CRC32_ROW4(n, ...) \
+    CRC32_ENTRY((n), __VA_ARGS__), CRC32_ENTRY((n) + 1, __VA_ARGS__), \
+    CRC32_ENTRY((n) + 2, __VA_ARGS__), CRC32_ENTRY((n) + 3, __VA_ARGS__)
+#define CRC32_ROW16(n, ...) \
+    CRC32_ROW4((n), __VA_ARGS__), CRC32_ROW4((n) + 4, __VA_ARGS__), \
+    CRC32_ROW4((n) + 8, __VA_ARGS__), CRC32_ROW4((n) + 12, __VA_ARGS__)
+#define CRC32_ROW64(n, ...) \
+    CRC32_ROW16((n), __VA_ARGS__), CRC32_ROW16((n) + 16, __VA_ARGS__), \
+    CRC32_ROW16((n) + 32, __VA_ARGS__), CRC32_ROW16((n) + 48, __VA_ARGS__)
+#define CRC32_TABLE(...) { \
+    CRC32_ROW64(0, __VA_ARGS__), CRC32_ROW64(64, __VA_ARGS__), \
+    CRC32_ROW64(128, __VA_ARGS__), CRC32_ROW64(192, __VA_ARGS__) }
+
+static const uint32_t crc32_tab[16][256] = {
+    CRC32_TABLE(0x77073096, 0xee0e612c, 0x076dc419, 0x0edb8832, 0x1db71064, 0x3b6e20c8, 0x76dc4190, 0xedb88320),
+    CRC32_TABLE(0x191b3141, 0x32366282, 0x646cc504, 0xc8d98a08, 0x4ac21251, 0x958424a2, 0xf0794f05, 0x3b83984b),
+    CRC32_TABLE(0x01c26a37, 0x0384d46e, 0x0709a8dc, 0x0e1351b8, 0x1c26a370, 0x384d46e0, 0x709a8dc0, 0xe1351b80),
+    CRC32_TABLE(0xb8bc6765, 0xaa09c88b, 0x8f629757, 0xc5b428ef, 0x5019579f, 0xa032af3e, 0x9b14583d, 0xed59b63b),
+    CRC32_TABLE(0x3d6029b0, 0x7ac05360, 0xf580a6c0, 0x30704bc1, 0x60e09782, 0xc1c12f04, 0x58f35849, 0xb1e6b092),
+    CRC32_TABLE(0xcb5cd3a5, 0x4dc8a10b, 0x9b914216, 0xec53826d, 0x03d6029b, 0x07ac0536, 0x0f580a6c, 0x1eb014d8),
+    CRC32_TABLE(0xa6770bb4, 0x979f1129, 0xf44f2413, 0x33ef4e67, 0x67de9cce, 0xcfbd399c, 0x440b7579, 0x8816eaf2),
+    CRC32_TABLE(0xccaa009e, 0x4225077d, 0x844a0efa, 0xd3e51bb5, 0x7cbb312b, 0xf9766256, 0x299dc2ed, 0x533b85da),
+    CRC32_TABLE(0x177b1443, 0x2ef62886, 0x5dec510c, 0xbbd8a218, 0xacc04271, 0x82f182a3, 0xde920307, 0x6655004f),
+    CRC32_TABLE(0xefc26b3e, 0x04f5d03d, 0x09eba07a, 0x13d740f4, 0x27ae81e8, 0x4f5d03d0, 0x9eba07a0, 0xe6050901),
+    CRC32_TABLE(0xc18edfc0, 0x586cb9c1, 0xb0d97382, 0xbac3e145, 0xaef6c4cb, 0x869c8fd7, 0xd64819ef, 0x77e1359f),
+    CRC32_TABLE(0x9ba54c6f, 0xec3b9e9f, 0x03063b7f, 0x060c76fe, 0x0c18edfc, 0x1831dbf8, 0x3063b7f0, 0x60c76fe0),
+    CRC32_TABLE(0xdd96d985, 0x605cb54b, 0xc0b96a96, 0x5a03d36d, 0xb407a6da, 0xb37e4bf5, 0xbd8d91ab, 0xa06a2517),
+    CRC32_TABLE(0x9d0fe176, 0xe16ec4ad, 0x19ac8f1b, 0x33591e36, 0x66b23c6c, 0xcd6478d8, 0x41b9f7f1, 0x8373efe2),
+    CRC32_TABLE(0xb9fbdbe8, 0xa886b191, 0x8a7c6563, 0xcf89cc87, 0x44629f4f, 0x88c53e9e, 0xcafb7b7d, 0x4e87f0bb),
+    CRC32_TABLE(0xae689191, 0x87a02563, 0xd4314c87, 0x73139f4f, 0xe6273e9e, 0x173f7b7d, 0x2e7ef6fa, 0x5cfdedf4),
+};
+
+static uint32_t read32le(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t crc32_bytewise(uint32_t crc, const uint8_t *p, size_t size) {
+    while(size--) {
+        crc = crc32_tab[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+static uint32_t crc32_slice8(uint32_t crc, const uint8_t *p, size_t size) {
+    while(size >= 8) {
+        uint32_t one = read32le(p) ^ crc;
+        uint32_t two = read32le(p + 4);
+        crc = crc32_tab[7][one & 0xFF] ^ crc32_tab[6][(one >> 8) & 0xFF] ^ crc32_tab[5][(one >> 16) & 0xFF] ^ crc32_tab[4][one >> 24] ^
+              crc32_tab[3][two & 0xFF] ^ crc32_tab[2][(two >> 8) & 0xFF] ^ crc32_tab[1][(two >> 16) & 0xFF] ^ crc32_tab[0][two >> 24];
+        p += 8;
+        size -= 8;
+    }
+
+    return crc32_bytewise(crc, p, size);
+}
+
+static uint32_t crc32_slice16(uint32_t crc, const uint8_t *p, size_t size) {
+    while(size >= 16) {
+        uint32_t one = read32le(p) ^ crc;
+        uint32_t two = read32le(p + 4);
+        uint32_t three = read32le(p + 8);
+        uint32_t four = read32le(p + 12);
+        crc = crc32_tab[15][one & 0xFF] ^ crc32_tab[14][(one >> 8) & 0xFF] ^ crc32_tab[13][(one >> 16) & 0xFF] ^ crc32_tab[12][one >> 24] ^
+              crc32_tab[11][two & 0xFF] ^ crc32_tab[10][(two >> 8) & 0xFF] ^ crc32_tab[9][(two >> 16) & 0xFF] ^ crc32_tab[8][two >> 24] ^
+              crc32_tab[7][three & 0xFF] ^ crc32_tab[6][(three >> 8) & 0xFF] ^ crc32_tab[5][(three >> 16) & 0xFF] ^ crc32_tab[4][three >> 24] ^
+              crc32_tab[3][four & 0xFF] ^ crc32_tab[2][(four >> 8) & 0xFF] ^ crc32_tab[1][(four >> 16) & 0xFF] ^ crc32_tab[0][four >> 24];
+        p += 16;
+        size -= 16;
+    }
+
+    return crc32_bytewise(crc, p, size);
+}
+
+#ifdef CRC32_HAVE_PCLMUL
+// Folding with carry-less multiplication, from Intel's "Fast CRC Computation for Generic Polynomials
+// Using PCLMULQDQ Instruction". Constants are for the bit-reflected 0x04C11DB7 polynomial.
+CRC32_TARGET_PCLMUL static uint32_t crc32_pclmul(uint32_t crc, const uint8_t *p, size_t size) {
+    if(size < 64) {
+        return crc32_slice16(crc, p, size);
+    }
+
+    alignas(16) static const uint64_t k1k2[] = { 0x0154442BD4, 0x01C6E41596 };
+    alignas(16) static const uint64_t k3k4[] = { 0x01751997D0, 0x00CCAA009E };
+    alignas(16) static const uint64_t k5k0[] = { 0x0163CD6124, 0x0000000000 };
+    alignas(16) static const uint64_t poly[] = { 0x01DB710641, 0x01F7011641 };
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    // Fold four lanes of 128 bits at a time
+    x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(p + 0x00)), _mm_cvtsi32_si128((int)crc));
+    x2 = _mm_loadu_si128((const __m128i *)(p + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(p + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(p + 0x30));
+    x0 = _mm_load_si128((const __m128i *)k1k2);
+    p += 64;
+    size -= 64;
+
+    while(size >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)(p + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *)(p + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *)(p + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *)(p + 0x30)));
+        p += 64;
+        size -= 64;
+    }
+
+    // Fold the four lanes into one
+    x0 = _mm_load_si128((const __m128i *)k3k4);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // Any remaining 16 byte blocks
+    while(size >= 16) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i *)p)), x5);
+        p += 16;
+        size -= 16;
+    }
+
+    // 128 bits to 64 bits
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, x0, 0x00), x2);
+
+    // Barrett reduction to 32 bits
+    x0 = _mm_load_si128((const __m128i *)poly);
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    crc = (uint32_t)_mm_extract_epi32(x1, 1);
+
+    return crc32_slice16(crc, p, size);
+}
+#endif
+
+#ifdef CRC32_HAVE_ARMV8
+CRC32_TARGET_ARMV8 static uint32_t crc32_armv8(uint32_t crc, const uint8_t *p, size_t size) {
+    while(size >= 8) {
+        uint64_t value = (uint64_t)read32le(p) | ((uint64_t)read32le(p + 4) << 32);
+        crc = __crc32d(crc, value);
+        p += 8;
+        size -= 8;
+    }
+
+    while(size--) {
+        crc = __crc32b(crc, *p++);
+    }
+
+    return crc;
+}
+#endif
+
+bool crc32_engine_available(enum crc32_engine engine) {
+    switch(engine) {
+        case CRC32_ENGINE_BYTEWISE:
+        case CRC32_ENGINE_SLICE8:
+        case CRC32_ENGINE_SLICE16:
+            return true;
+#ifdef CRC32_HAVE_PCLMUL
+        case CRC32_ENGINE_PCLMUL:
+    #ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 1)) && (info[2] & (1 << 19));
+    #else
+            return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+    #endif
+#endif
+#ifdef CRC32_HAVE_ARMV8
+        case CRC32_ENGINE_ARMV8:
+    #if defined(__ARM_FEATURE_CRC32) || defined(__APPLE__)
+            return true;
+    #elif defined(_MSC_VER)
+            return IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE);
+    #elif defined(__linux__)
+            return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+    #else
+            return false;
+    #endif
+#endif
+        default:
+            return false;
+    }
+}
+
+const char *crc32_engine_name(enum crc32_engine engine) {
+    switch(engine) {
+        case CRC32_ENGINE_BYTEWISE:
+            return "bytewise";
+        case CRC32_ENGINE_SLICE8:
+            return "slice-by-8";
+        case CRC32_ENGINE_SLICE16:
+            return "slice-by-16";
+        case CRC32_ENGINE_PCLMUL:
+            return "pclmulqdq";
+        case CRC32_ENGINE_ARMV8:
+            return "armv8-crc";
+        default:
+            return "unknown";
+    }
+}
+
+uint32_t crc32_with_engine(enum crc32_engine engine, uint32_t crc, const void *buf, size_t size) {
+    const uint8_t *p = buf;
+    switch(engine) {
+        case CRC32_ENGINE_SLICE8:
+            return crc32_slice8(crc, p, size);
+        case CRC32_ENGINE_SLICE16:
+            return crc32_slice16(crc, p, size);
+#ifdef CRC32_HAVE_PCLMUL
+        case CRC32_ENGINE_PCLMUL:
+            return crc32_pclmul(crc, p, size);
+#endif
+#ifdef CRC32_HAVE_ARMV8
+        case CRC32_ENGINE_ARMV8:
+            return crc32_armv8(crc, p, size);
+#endif
+        default:
+            return crc32_bytewise(crc, p, size);
+    }
+}
+
+// Picked once on first use
+static enum crc32_engine best_engine = CRC32_ENGINE_SLICE16;
+static once_flag best_engine_once = ONCE_FLAG_INIT;
+
+static void pick_best_engine(void) {
+    if(crc32_engine_available(CRC32_ENGINE_PCLMUL)) {
+        best_engine = CRC32_ENGINE_PCLMUL;
+    }
+    else if(crc32_engine_available(CRC32_ENGINE_ARMV8)) {
+        best_engine = CRC32_ENGINE_ARMV8;
+    }
+}
+
+uint32_t crc32(uint32_t crc, const void *buf, size_t size) {
+    call_once(&best_engine_once, pick_best_engine);
+    return crc32_with_engine(best_engine, crc, buf, size);
+}
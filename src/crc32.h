@@ -0,0 +1,25 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Implementations that can be used to calculate a tag checksum. All of them give the same result.
+enum crc32_engine {
+    CRC32_ENGINE_BYTEWISE,
+    CRC32_ENGINE_SLICE8,
+    CRC32_ENGINE_SLICE16,
+    CRC32_ENGINE_PCLMUL,
+    CRC32_ENGINE_ARMV8,
+    CRC32_ENGINE_COUNT
+};
+
+// Continue a CRC32 over buf using the fastest engine the CPU supports.
+// Tag checksums start with 0xFFFFFFFF and are not inverted at the end.
+uint32_t crc32(uint32_t crc, const void *buf, size_t size);
+
+// Same as crc32() but with a specific engine. Engine must be available.
+uint32_t crc32_with_engine(enum crc32_engine engine, uint32_t crc, const void *buf, size_t size);
+bool crc32_engine_available(enum crc32_engine engine);
+const char *crc32_engine_name(enum crc32_engine engine);
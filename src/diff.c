@@ -0,0 +1,226 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diff.h"
+#include "font_tag.h"
+#include "mapped_file.h"
+#include "stats.h"
+
+#define DIFF_NONE UINT32_MAX
+
+struct diff_tag {
+    const char *path;
+    struct mapped_file file;
+    struct font_tag_layout layout;
+    uint32_t *sorted; // indices of the characters in character order
+    uint32_t sorted_count;
+};
+
+// Put the indices of a tag's characters in character order, keeping the first of any duplicates.
+// first_index is scratch space for one index per character.
+static void sort_characters(struct diff_tag *tag, uint32_t *first_index) {
+    const struct font_tag_layout *layout = &tag->layout;
+
+    // Tags made by join are sorted already
+    bool sorted = true;
+    for(uint32_t i = 1; i < layout->characters_count && sorted; i++) {
+        sorted = byteswap16(layout->characters[i].character) > byteswap16(layout->characters[i - 1].character);
+    }
+
+    if(sorted) {
+        for(uint32_t i = 0; i < layout->characters_count; i++) {
+            tag->sorted[i] = i;
+        }
+        tag->sorted_count = layout->characters_count;
+        return;
+    }
+
+    // Backwards, so the first of any duplicates is the one left
+    memset(first_index, 0xFF, (UINT16_MAX + 1) * sizeof(uint32_t));
+    for(uint32_t i = layout->characters_count; i-- > 0;) {
+        first_index[byteswap16(layout->characters[i].character)] = i;
+    }
+
+    tag->sorted_count = 0;
+    for(uint32_t character = 0; character <= UINT16_MAX; character++) {
+        if(first_index[character] != DIFF_NONE) {
+            tag->sorted[tag->sorted_count++] = first_index[character];
+        }
+    }
+}
+
+// Add "name old -> new" to a line of changes
+#define DIFF_FIELD(line, length, name, old_value, new_value) \
+    if((old_value) != (new_value)) { \
+        length += snprintf(line + length, sizeof(line) - length, "%s%s %d -> %d", length ? ", " : "", name, (int)(old_value), (int)(new_value)); \
+    }
+
+static void print_style_font_name(const char *name, size_t length) {
+    if(name) {
+        printf("\"%.*s\"", (int)length, name);
+    }
+    else {
+        printf("none");
+    }
+}
+
+static uint32_t diff_font_base(const struct font_tag_layout *old_tag, const struct font_tag_layout *new_tag) {
+    const struct font_base *old_font = old_tag->font;
+    const struct font_base *new_font = new_tag->font;
+    uint32_t changed = 0;
+    if(old_font->flags != new_font->flags) {
+        printf("flags: 0x%08X -> 0x%08X\n", byteswap32(old_font->flags), byteswap32(new_font->flags));
+        changed++;
+    }
+
+    char line[256];
+    int length = 0;
+    DIFF_FIELD(line, length, "ascending_height", (int16_t)byteswap16(old_font->ascending_height), (int16_t)byteswap16(new_font->ascending_height));
+    DIFF_FIELD(line, length, "descending_height", (int16_t)byteswap16(old_font->descending_height), (int16_t)byteswap16(new_font->descending_height));
+    DIFF_FIELD(line, length, "leading_height", (int16_t)byteswap16(old_font->leading_height), (int16_t)byteswap16(new_font->leading_height));
+    DIFF_FIELD(line, length, "leading_width", (int16_t)byteswap16(old_font->leading_width), (int16_t)byteswap16(new_font->leading_width));
+    if(length != 0) {
+        printf("font: %s\n", line);
+        changed++;
+    }
+
+    for(int i = 0; i < STYLE_FONTS_COUNT; i++) {
+        const char *old_name = old_tag->style_font_names[i];
+        const char *new_name = new_tag->style_font_names[i];
+        size_t old_length = old_tag->style_font_name_lengths[i];
+        size_t new_length = new_tag->style_font_name_lengths[i];
+        if(old_length != new_length || (old_length != 0 && memcmp(old_name, new_name, old_length) != 0)) {
+            printf("style font %d: ", i);
+            print_style_font_name(old_name, old_length);
+            printf(" -> ");
+            print_style_font_name(new_name, new_length);
+            printf("\n");
+            changed++;
+        }
+    }
+
+    if(old_tag->character_tables_count != new_tag->character_tables_count) {
+        printf("character tables: %u -> %u\n", old_tag->character_tables_count, new_tag->character_tables_count);
+        changed++;
+    }
+
+    if(old_tag->pixel_data_size != new_tag->pixel_data_size) {
+        printf("pixel data: %zu -> %zu bytes\n", old_tag->pixel_data_size, new_tag->pixel_data_size);
+        changed++;
+    }
+
+    return changed;
+}
+
+// Compare a character that is in both tags. Returns false if either one's pixels are out of bounds.
+static bool diff_character(const struct diff_tag *old_tag, uint32_t old_index, const struct diff_tag *new_tag, uint32_t new_index, struct diff_result *result) {
+    struct font_glyph old_glyph;
+    struct font_glyph new_glyph;
+    if(!font_tag_glyph(&old_tag->layout, old_index, &old_glyph)) {
+        fprintf(stderr, "%s: Character %u has pixel data out of bounds\n", old_tag->path, byteswap16(old_tag->layout.characters[old_index].character));
+        return false;
+    }
+    if(!font_tag_glyph(&new_tag->layout, new_index, &new_glyph)) {
+        fprintf(stderr, "%s: Character %u has pixel data out of bounds\n", new_tag->path, byteswap16(new_tag->layout.characters[new_index].character));
+        return false;
+    }
+
+    char line[512];
+    int length = 0;
+    DIFF_FIELD(line, length, "character_width", old_glyph.character_width, new_glyph.character_width);
+    DIFF_FIELD(line, length, "bitmap_width", old_glyph.bitmap_width, new_glyph.bitmap_width);
+    DIFF_FIELD(line, length, "bitmap_height", old_glyph.bitmap_height, new_glyph.bitmap_height);
+    DIFF_FIELD(line, length, "bitmap_origin_x", old_glyph.bitmap_origin_x, new_glyph.bitmap_origin_x);
+    DIFF_FIELD(line, length, "bitmap_origin_y", old_glyph.bitmap_origin_y, new_glyph.bitmap_origin_y);
+    DIFF_FIELD(line, length, "hardware_character_index", old_glyph.hardware_character_index, new_glyph.hardware_character_index);
+    bool metrics_changed = length != 0;
+
+    // Both tags are mapped, so comparing the bytes is quicker than hashing them and can't collide
+    bool pixels_changed = old_glyph.pixels_size != new_glyph.pixels_size || memcmp(old_glyph.pixels, new_glyph.pixels, old_glyph.pixels_size) != 0;
+    if(pixels_changed) {
+        length += snprintf(line + length, sizeof(line) - length, "%spixels", length ? ", " : "");
+    }
+
+    if(length != 0) {
+        printf("changed %u: %s\n", old_glyph.character, line);
+    }
+
+    result->metrics_changed += metrics_changed;
+    result->pixels_changed += pixels_changed;
+    result->unchanged += length == 0;
+
+    return true;
+}
+
+bool diff_font_tags(const char *old_path, const char *new_path, struct diff_result *result, struct workspace *workspace) {
+    struct diff_tag tags[2] = { { .path = old_path }, { .path = new_path } };
+    struct diff_result new_result = {0};
+    bool success = false;
+
+    stats_phase(workspace->stats, "map");
+    for(int t = 0; t < 2; t++) {
+        if(!mapped_file_open(&tags[t].file, tags[t].path) || !read_font_tag_layout(tags[t].path, tags[t].file.data, tags[t].file.size, &tags[t].layout)) {
+            goto cleanup;
+        }
+
+        stats_count(workspace->stats, STATS_FILES_OPENED, 1);
+        stats_count(workspace->stats, STATS_BYTES_READ, tags[t].file.size);
+
+        tags[t].sorted = malloc(tags[t].layout.characters_count * sizeof(uint32_t));
+        if(!tags[t].sorted) {
+            fprintf(stderr, "Could not allocate character order for %s\n", tags[t].path);
+            goto cleanup;
+        }
+    }
+
+    stats_phase(workspace->stats, "sort");
+    sort_characters(&tags[0], workspace->selected);
+    sort_characters(&tags[1], workspace->selected);
+
+    stats_phase(workspace->stats, "compare");
+    new_result.font_base_changed = diff_font_base(&tags[0].layout, &tags[1].layout);
+
+    // Both are in character order, so walk them together
+    uint32_t o = 0;
+    uint32_t n = 0;
+    while(o < tags[0].sorted_count || n < tags[1].sorted_count) {
+        uint32_t old_character = o < tags[0].sorted_count ? byteswap16(tags[0].layout.characters[tags[0].sorted[o]].character) : DIFF_NONE;
+        uint32_t new_character = n < tags[1].sorted_count ? byteswap16(tags[1].layout.characters[tags[1].sorted[n]].character) : DIFF_NONE;
+        if(old_character < new_character) {
+            printf("removed %u\n", old_character);
+            new_result.removed++;
+            o++;
+        }
+        else if(new_character < old_character) {
+            printf("added %u\n", new_character);
+            new_result.added++;
+            n++;
+        }
+        else {
+            if(!diff_character(&tags[0], tags[0].sorted[o], &tags[1], tags[1].sorted[n], &new_result)) {
+                goto cleanup;
+            }
+            o++;
+            n++;
+        }
+    }
+
+    printf("%s -> %s: %u font fields changed, %u characters added, %u removed, %u with new metrics, %u with new pixels, %u the same\n",
+           old_path, new_path, new_result.font_base_changed, new_result.added, new_result.removed, new_result.metrics_changed, new_result.pixels_changed, new_result.unchanged);
+    if(result) {
+        *result = new_result;
+    }
+    success = true;
+
+    cleanup:
+    for(int t = 0; t < 2; t++) {
+        mapped_file_close(&tags[t].file);
+        free(tags[t].sorted);
+    }
+
+    return success;
+}
@@ -0,0 +1,21 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+
+#include "workspace.h"
+
+struct diff_result {
+    uint32_t font_base_changed; // font base fields and style font names that are different
+    uint32_t added;
+    uint32_t removed;
+    uint32_t metrics_changed;
+    uint32_t pixels_changed;
+    uint32_t unchanged;
+};
+
+// Print what changed from one font tag to another: font base fields and style font names first, then each character
+// that was added, removed, or has different metrics or pixels, in character order, then a summary. Characters are
+// matched by what character they are, and only the first of any duplicates counts, like split. result can be null.
+bool diff_font_tags(const char *old_path, const char *new_path, struct diff_result *result, struct workspace *workspace);
@@ -0,0 +1,112 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Tags are big endian. Everything here is kept in that layout and swapped on use.
+
+enum signatures {
+    TAG_HEADER_SIGNATURE = 0x626C616D, // 'blam'
+    FONT_SIGNATURE = 0x666F6E74, // 'font'
+    NULL_SIGNATURE = 0xFFFFFFFF
+};
+
+struct tag_header {
+	char pad1[36];
+	uint32_t tag_group;
+	uint32_t checksum;
+	uint32_t offset; // offset to tag data, always 64
+	uint32_t size; // never set 😭
+	char pad2[4];
+	uint16_t version; // version of the tag
+	char pad3;
+	uint8_t unused_index; // always 255
+	uint32_t signature; // always 'blam'
+};
+static_assert(sizeof(struct tag_header) == 64);
+
+struct tag_reflexive {
+	uint32_t count;
+	uint32_t address; // 32-bit pointer to array
+	uint32_t definition; // 32-bit pointer to tag definition (in-engine only)
+};
+static_assert(sizeof(struct tag_reflexive) == 12);
+
+struct tag_data {
+	uint32_t size;
+	char pad[4];
+	uint32_t file_offset; // not in loose tags
+	uint32_t address; // 32-bit pointer to data
+	uint32_t definition;// 32-bit pointer to data definition (in-engine only)
+};
+static_assert(sizeof(struct tag_data) == 20);
+
+struct tag_reference {
+	uint32_t tag_group;
+	uint32_t name; // 32-bit pointer to name
+	uint32_t name_length;
+	uint32_t index; //tag index (two-part tag id)
+};
+static_assert(sizeof(struct tag_reference) == 16);
+
+struct font_character_table_entry {
+	uint16_t character_index;
+};
+static_assert(sizeof(struct font_character_table_entry) == 2);
+
+struct font_character_tables_entry {
+	struct tag_reflexive table;
+};
+static_assert(sizeof(struct font_character_tables_entry) == 12);
+
+struct font_character {
+	uint16_t character;
+	int16_t character_width;
+	int16_t bitmap_width;
+	int16_t bitmap_height;
+	int16_t bitmap_origin_x;
+	int16_t bitmap_origin_y;
+	uint16_t hardware_character_index;
+	char pad[2];
+	uint32_t pixels_offset; // offset into pixels buffer
+};
+static_assert(sizeof(struct font_character) == 20);
+
+#define STYLE_FONTS_COUNT 4
+struct font_base {
+	uint32_t flags;
+	int16_t ascending_height;
+	int16_t descending_height;
+	int16_t leading_height;
+	int16_t leading_width;
+	char pad[36];
+	struct tag_reflexive character_tables; // we don't care about these.
+	struct tag_reference style_fonts[STYLE_FONTS_COUNT];
+	struct tag_reflexive characters;
+	struct tag_data pixels;
+};
+static_assert(sizeof(struct font_base) == 156);
+
+static inline uint16_t byteswap16(uint16_t value) {
+    return (value << 8) | (value >> 8);
+}
+
+static inline uint32_t byteswap32(uint32_t value) {
+    return ((value & 0xFF) << 24) | ((value & 0xFF00) << 8) | ((value & 0xFF0000) >> 8) | (value >> 24);
+}
+
+static inline uint64_t byteswap64(uint64_t value) {
+    return ((uint64_t)byteswap32(value & 0xFFFFFFFF) << 32) | byteswap32(value >> 32);
+}
+
+static inline size_t calculate_pixels_size(int16_t width, int16_t height) {
+    size_t pixels_size = 0;
+    // Ask bungie
+    if(width > 0 && height > 0) {
+        pixels_size = width * height;
+    }
+
+    return pixels_size;
+}
@@ -0,0 +1,20 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+// Everything the font-slicer command line tool does, as a library.
+//
+// Nothing keeps state between calls except what is passed in. Splitting and joining use a workspace for their
+// buffers, and a workspace can be reused for any number of calls but only by one thread at a time. Tags can also
+// be read and built entirely in memory with read_font_tag_layout, font_tag_glyph, font_tag_find_glyph and build_font_tag.
+
+#include "diff.h"
+#include "font.h"
+#include "font_tag.h"
+#include "join.h"
+#include "merge.h"
+#include "repack.h"
+#include "split.h"
+#include "stats.h"
+#include "verify.h"
+#include "workspace.h"
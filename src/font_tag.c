@@ -0,0 +1,372 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "character_tables.h"
+#include "crc32.h"
+#include "font_tag.h"
+#include "glyph_set.h"
+#include "pixel_pack.h"
+
+bool read_font_tag_layout(const char *tag_path, const uint8_t *buffer_in, size_t buffer_in_size, struct font_tag_layout *layout) {
+    // Check if big enough
+    if(buffer_in_size < sizeof(struct tag_header) + sizeof(struct font_base)) {
+        fprintf(stderr, "%s is too small to be a valid font tag\n", tag_path);
+        return false;
+    }
+
+    // Check if it's really a font tag
+    const struct tag_header *header = (const struct tag_header *)buffer_in;
+    if(byteswap32(header->signature) != TAG_HEADER_SIGNATURE || byteswap32(header->tag_group) != FONT_SIGNATURE) {
+        fprintf(stderr, "%s is not a valid font tag\n", tag_path);
+        return false;
+    }
+
+    const struct font_base *font = (const struct font_base *)(buffer_in + sizeof(struct tag_header));
+
+    // do we even have characters?
+    uint32_t characters_count = byteswap32(font->characters.count);
+    if(characters_count == 0) {
+        fprintf(stderr, "%s has no characters\n", tag_path);
+        return false;
+    }
+
+    // do we have too many characters?
+    if(characters_count > UINT16_MAX) {
+        fprintf(stderr, "%s has too many characters to be a valid font tag\n", tag_path);
+        return false;
+    }
+
+    // do we have pixel data?
+    size_t pixel_data_size = byteswap32(font->pixels.size);
+    if(pixel_data_size == 0) {
+        fprintf(stderr, "%s has no pixel data\n", tag_path);
+        return false;
+    }
+
+    // Start going through the rest of the tag data
+    *layout = (struct font_tag_layout){
+        .header = header,
+        .font = font,
+        .characters_count = characters_count,
+        .pixel_data_size = pixel_data_size
+    };
+    size_t font_tag_cursor = sizeof(struct tag_header) + sizeof(struct font_base);
+
+    // Character tables are a list of tables followed by the indices in each of them
+    uint32_t character_tables_count = byteswap32(font->character_tables.count);
+    if(character_tables_count != 0) {
+        size_t character_tables_size = character_tables_count * sizeof(struct font_character_tables_entry);
+        if(buffer_in_size - font_tag_cursor < character_tables_size) {
+            fprintf(stderr, "%s has character tables that are out of bounds\n", tag_path);
+            return false;
+        }
+
+        const struct font_character_tables_entry *character_tables = (const struct font_character_tables_entry *)(buffer_in + font_tag_cursor);
+        font_tag_cursor += character_tables_size;
+
+        size_t character_table_data_count = 0;
+        layout->character_tables_usable = character_tables_count <= 256;
+        for(uint32_t i = 0; i < character_tables_count; i++) {
+            uint32_t table_count = byteswap32(character_tables[i].table.count);
+            if(i < 256) {
+                layout->character_table_starts[i] = character_table_data_count;
+            }
+            if(table_count != 0 && table_count != 256) {
+                layout->character_tables_usable = false;
+            }
+            character_table_data_count += table_count;
+            if((buffer_in_size - font_tag_cursor) / sizeof(struct font_character_table_entry) < character_table_data_count) {
+                fprintf(stderr, "%s has character tables that are out of bounds\n", tag_path);
+                return false;
+            }
+        }
+
+        layout->character_tables = character_tables;
+        layout->character_tables_count = character_tables_count;
+        layout->character_table_data = (const struct font_character_table_entry *)(buffer_in + font_tag_cursor);
+        font_tag_cursor += character_table_data_count * sizeof(struct font_character_table_entry);
+    }
+
+    layout->style_font_names_offset = font_tag_cursor;
+
+    // Add up any paths from the references
+    for(int i = 0; i < STYLE_FONTS_COUNT; i++) {
+        uint32_t name_legnth = byteswap32(font->style_fonts[i].name_length);
+        if(name_legnth != 0) {
+            if(buffer_in_size - font_tag_cursor <= name_legnth) {
+                fprintf(stderr, "%s has style font names that are out of bounds\n", tag_path);
+                return false;
+            }
+
+            layout->style_font_names[i] = (const char *)(buffer_in + font_tag_cursor);
+            layout->style_font_name_lengths[i] = name_legnth;
+            font_tag_cursor += name_legnth + 1;
+        }
+    }
+
+    // Offset to character data
+    layout->characters_offset = font_tag_cursor;
+    layout->characters = (const struct font_character *)(buffer_in + font_tag_cursor);
+
+    // Offset to pixel data
+    size_t pixel_data_offset = font_tag_cursor + characters_count * sizeof(struct font_character);
+    if(buffer_in_size < pixel_data_offset || buffer_in_size - pixel_data_offset != pixel_data_size) {
+        fprintf(stderr, "%s is fucked\n", tag_path);
+        return false;
+    }
+
+    layout->pixel_data = buffer_in + pixel_data_offset;
+
+    return true;
+}
+
+bool font_tag_glyph(const struct font_tag_layout *layout, uint32_t index, struct font_glyph *glyph) {
+    if(index >= layout->characters_count || !character_pixels_in_bounds(&layout->characters[index], layout->pixel_data_size)) {
+        return false;
+    }
+
+    const struct font_character *character = &layout->characters[index];
+    *glyph = (struct font_glyph){
+        .index = index,
+        .character = byteswap16(character->character),
+        .character_width = byteswap16(character->character_width),
+        .bitmap_width = byteswap16(character->bitmap_width),
+        .bitmap_height = byteswap16(character->bitmap_height),
+        .bitmap_origin_x = byteswap16(character->bitmap_origin_x),
+        .bitmap_origin_y = byteswap16(character->bitmap_origin_y),
+        .hardware_character_index = byteswap16(character->hardware_character_index)
+    };
+    glyph->pixels_size = calculate_pixels_size(glyph->bitmap_width, glyph->bitmap_height);
+    glyph->pixels = layout->pixel_data + (glyph->pixels_size ? byteswap32(character->pixels_offset) : 0);
+
+    return true;
+}
+
+bool font_tag_find_glyph(const struct font_tag_layout *layout, uint16_t character, struct font_glyph *glyph) {
+    uint16_t character_swapped = byteswap16(character);
+
+    // A table for each high byte, indexed by the low byte. Stale tables can leave a character out as well as point at the
+    // wrong one, so anything but a match falls back to searching.
+    uint32_t table = character >> 8;
+    if(layout->character_tables_usable && table < layout->character_tables_count && layout->character_tables[table].table.count != 0) {
+        uint16_t index = byteswap16(layout->character_table_data[layout->character_table_starts[table] + (character & 0xFF)].character_index);
+        if(index < layout->characters_count && layout->characters[index].character == character_swapped) {
+            return font_tag_glyph(layout, index, glyph);
+        }
+    }
+
+    for(uint32_t i = 0; i < layout->characters_count; i++) {
+        if(layout->characters[i].character == character_swapped) {
+            return font_tag_glyph(layout, i, glyph);
+        }
+    }
+
+    return false;
+}
+
+bool character_pixels_in_bounds(const struct font_character *character, size_t pixel_data_size) {
+    size_t pixels_size = calculate_pixels_size(byteswap16(character->bitmap_width), byteswap16(character->bitmap_height));
+    return pixels_size == 0 || (pixels_size <= pixel_data_size && byteswap32(character->pixels_offset) <= pixel_data_size - pixels_size);
+}
+
+
+uint32_t font_tag_checksum(const uint8_t *tag_data, size_t tag_size) {
+    if(tag_size < sizeof(struct tag_header)) {
+        return 0;
+    }
+
+    return crc32(0xFFFFFFFF, tag_data + sizeof(struct tag_header), tag_size - sizeof(struct tag_header));
+}
+
+// Set up the header and font base of a new tag
+static void make_font_tag_base(struct tag_header *new_tag_header, struct font_base *new_font_base, const struct glyph_metrics *metrics, uint32_t characters_count, uint32_t character_tables_count, size_t pixel_data_size) {
+    // Setup header
+    *new_tag_header = (struct tag_header){0};
+    new_tag_header->tag_group = byteswap32(FONT_SIGNATURE);
+    new_tag_header->offset = byteswap32(sizeof(struct tag_header));
+    new_tag_header->unused_index = 255;
+    new_tag_header->version = byteswap16(1);
+    new_tag_header->signature = byteswap32(TAG_HEADER_SIGNATURE);
+
+    // Setup font base struct
+    *new_font_base = (struct font_base){0};
+
+    // Approximate. Will match invader-font, but tool.exe uses values directly from Windows
+    // These can be adjusted after the fact anyway
+    new_font_base->ascending_height = byteswap16(metrics->max_ascending_height);
+    new_font_base->descending_height = byteswap16(metrics->max_descending_height);
+    new_font_base->pixels.size = byteswap32(pixel_data_size);
+    new_font_base->character_tables.count = byteswap32(character_tables_count);
+    new_font_base->characters.count = byteswap32(characters_count);
+
+    // I could leave this, but I want the file to round-trip as if it were just made by invader-font
+    for(int i = 0; i < STYLE_FONTS_COUNT; i++) {
+        new_font_base->style_fonts[i].tag_group = byteswap32(FONT_SIGNATURE);
+        new_font_base->style_fonts[i].index = 0xFFFFFFFF;
+    }
+}
+
+bool start_font_tag(struct tag_writer *writer, const char *output_path, const struct font_character *characters, uint32_t characters_count, size_t pixel_data_size, uint8_t *character_tables, struct stats *stats) {
+    if(pixel_data_size > UINT32_MAX) {
+        fprintf(stderr, "Too much pixel data for a font tag (%zu bytes)\n", pixel_data_size);
+        return false;
+    }
+
+    uint32_t character_tables_count = 0;
+    size_t character_tables_size = 0;
+    if(character_tables) {
+        character_tables_count = build_character_tables(characters, characters_count, character_tables, &character_tables_size);
+    }
+
+    struct glyph_metrics metrics;
+    font_characters_metrics(characters, characters_count, &metrics);
+
+    struct tag_header new_tag_header;
+    struct font_base new_font_base;
+    make_font_tag_base(&new_tag_header, &new_font_base, &metrics, characters_count, character_tables_count, pixel_data_size);
+    if(!tag_writer_open(writer, output_path, &new_tag_header)) {
+        return false;
+    }
+
+    writer->stats = stats;
+    tag_writer_write(writer, &new_font_base, sizeof(new_font_base));
+    tag_writer_write(writer, character_tables, character_tables_size);
+    if(!tag_writer_write(writer, characters, characters_count * sizeof(struct font_character))) {
+        tag_writer_abort(writer);
+        return false;
+    }
+
+    return true;
+}
+
+bool write_font_tag_from(const struct font_tag_layout *tag, const char *output_path, const struct font_character *characters, uint32_t characters_count,
+                         const uint8_t *pixel_data, size_t pixel_data_size, uint8_t *character_tables, struct stats *stats, size_t *tag_size) {
+    if(pixel_data_size > UINT32_MAX) {
+        fprintf(stderr, "Too much pixel data for a font tag (%zu bytes)\n", pixel_data_size);
+        return false;
+    }
+
+    uint32_t character_tables_count = 0;
+    size_t character_tables_size = 0;
+    if(character_tables) {
+        character_tables_count = build_character_tables(characters, characters_count, character_tables, &character_tables_size);
+    }
+
+    struct font_base new_font_base = *tag->font;
+    new_font_base.character_tables.count = byteswap32(character_tables_count);
+    new_font_base.characters.count = byteswap32(characters_count);
+    new_font_base.pixels.size = byteswap32(pixel_data_size);
+
+    struct tag_writer writer;
+    if(!tag_writer_open(&writer, output_path, tag->header)) {
+        return false;
+    }
+
+    writer.stats = stats;
+    const uint8_t *style_font_names = (const uint8_t *)tag->header + tag->style_font_names_offset;
+    tag_writer_write(&writer, &new_font_base, sizeof(new_font_base));
+    tag_writer_write(&writer, character_tables, character_tables_size);
+    tag_writer_write(&writer, style_font_names, tag->characters_offset - tag->style_font_names_offset);
+    tag_writer_write(&writer, characters, characters_count * sizeof(struct font_character));
+    tag_writer_write(&writer, pixel_data, pixel_data_size);
+    if(tag_size) {
+        *tag_size = writer.size;
+    }
+
+    return tag_writer_close(&writer);
+}
+
+bool build_font_tag(const struct font_character *characters, uint32_t characters_count, const uint8_t *pixel_data, size_t pixel_data_size,
+                    bool character_tables, bool dedup, uint8_t **tag_data, size_t *tag_size) {
+    if(characters_count == 0 || characters_count > UINT16_MAX) {
+        fprintf(stderr, "A font tag needs 1 to %u characters, not %u\n", UINT16_MAX, characters_count);
+        return false;
+    }
+
+    struct glyph_set glyphs;
+    if(!glyph_set_init(&glyphs, characters_count)) {
+        return false;
+    }
+
+    // Offsets are rewritten when the pixels are packed, so work on a copy
+    struct font_character *new_characters = malloc(characters_count * sizeof(struct font_character));
+    uint8_t *new_character_tables = character_tables ? malloc(CHARACTER_TABLES_MAX_SIZE) : nullptr;
+    uint8_t *tag = nullptr;
+    bool success = false;
+    if(!new_characters || (character_tables && !new_character_tables)) {
+        fprintf(stderr, "Could not allocate font tag buffers\n");
+        goto cleanup;
+    }
+
+    glyph_set_decode(&glyphs, characters, characters_count);
+    for(uint32_t i = 0; i < characters_count; i++) {
+        if(i > 0 && glyphs.character[i] <= glyphs.character[i - 1]) {
+            fprintf(stderr, "Characters must be sorted with no duplicates (%u comes after %u)\n", glyphs.character[i], glyphs.character[i - 1]);
+            goto cleanup;
+        }
+
+        if(!glyph_set_pixels_in_bounds(&glyphs, i, pixel_data_size)) {
+            fprintf(stderr, "Pixel data for character %u is out of bounds\n", glyphs.character[i]);
+            goto cleanup;
+        }
+    }
+
+    struct glyph_metrics metrics;
+    glyph_set_metrics(&glyphs, &metrics);
+    size_t unpacked_size = metrics.pixels_size;
+
+    memcpy(new_characters, characters, characters_count * sizeof(struct font_character));
+    uint32_t character_tables_count = 0;
+    size_t character_tables_size = 0;
+    if(character_tables) {
+        character_tables_count = build_character_tables(new_characters, characters_count, new_character_tables, &character_tables_size);
+    }
+
+    // Pixels are packed straight into the tag, which may end up smaller than this with dedup
+    size_t characters_offset = sizeof(struct tag_header) + sizeof(struct font_base) + character_tables_size;
+    size_t pixel_data_offset = characters_offset + characters_count * sizeof(struct font_character);
+    tag = malloc(pixel_data_offset + unpacked_size);
+    if(!tag) {
+        fprintf(stderr, "Could not allocate %zu bytes for font tag\n", pixel_data_offset + unpacked_size);
+        goto cleanup;
+    }
+
+    struct pixel_pack_result packed;
+    if(!pack_pixels(new_characters, characters_count, pixel_data, tag + pixel_data_offset, dedup, &packed)) {
+        goto cleanup;
+    }
+
+    if(packed.pixels_size > UINT32_MAX) {
+        fprintf(stderr, "Too much pixel data for a font tag (%zu bytes)\n", packed.pixels_size);
+        goto cleanup;
+    }
+
+    struct tag_header new_tag_header;
+    struct font_base new_font_base;
+    make_font_tag_base(&new_tag_header, &new_font_base, &metrics, characters_count, character_tables_count, packed.pixels_size);
+    memcpy(tag + sizeof(struct tag_header), &new_font_base, sizeof(new_font_base));
+    if(character_tables_size != 0) {
+        memcpy(tag + sizeof(struct tag_header) + sizeof(struct font_base), new_character_tables, character_tables_size);
+    }
+    memcpy(tag + characters_offset, new_characters, characters_count * sizeof(struct font_character));
+
+    *tag_size = pixel_data_offset + packed.pixels_size;
+    new_tag_header.checksum = byteswap32(font_tag_checksum(tag, *tag_size));
+    memcpy(tag, &new_tag_header, sizeof(new_tag_header));
+
+    *tag_data = tag;
+    tag = nullptr;
+    success = true;
+
+    cleanup:
+    glyph_set_free(&glyphs);
+    free(new_characters);
+    free(new_character_tables);
+    free(tag);
+
+    return success;
+}
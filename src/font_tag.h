@@ -0,0 +1,76 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "font.h"
+#include "stats.h"
+#include "tag_writer.h"
+
+// Where everything is in a font tag that has been read into memory. Everything here has been bounds checked, and
+// nothing is copied or byteswapped, so it points into the buffer the tag was read from.
+struct font_tag_layout {
+    const struct tag_header *header;
+    const struct font_base *font;
+    const struct font_character_tables_entry *character_tables;
+    uint32_t character_tables_count;
+    const struct font_character_table_entry *character_table_data; // indices of every table, one after another
+    uint32_t character_table_starts[256]; // where each of the first 256 tables starts in character_table_data
+    bool character_tables_usable; // every table is empty or has an index for each low byte, so they can be used to find characters
+    const char *style_font_names[STYLE_FONTS_COUNT]; // null if there is no name
+    size_t style_font_name_lengths[STYLE_FONTS_COUNT];
+    const struct font_character *characters;
+    uint32_t characters_count;
+    size_t style_font_names_offset; // character tables sit between the font base and this
+    size_t characters_offset;
+    const uint8_t *pixel_data;
+    size_t pixel_data_size;
+};
+
+// A character from a font tag in host byte order, with its pixels
+struct font_glyph {
+    uint32_t index; // where it is in the tag
+    uint16_t character;
+    int16_t character_width;
+    int16_t bitmap_width;
+    int16_t bitmap_height;
+    int16_t bitmap_origin_x;
+    int16_t bitmap_origin_y;
+    uint16_t hardware_character_index;
+    const uint8_t *pixels; // points into the tag
+    size_t pixels_size;
+};
+
+// Check that a font tag is well formed and find where each part of it is, in one pass over the tag's structure.
+// Characters and pixels are not read, so this costs the same however big the tag is. tag_path is only used in messages.
+bool read_font_tag_layout(const char *tag_path, const uint8_t *buffer_in, size_t buffer_in_size, struct font_tag_layout *layout);
+
+// Get a character from a tag. Fails if index is past the last character or its pixels are out of bounds.
+bool font_tag_glyph(const struct font_tag_layout *layout, uint32_t index, struct font_glyph *glyph);
+
+// Find a character in a tag by what character it is. If the tag has usable character tables they are tried first, like
+// the game does, and the characters are searched if they don't lead to it. The first one wins if there are duplicates.
+bool font_tag_find_glyph(const struct font_tag_layout *layout, uint16_t character, struct font_glyph *glyph);
+
+// Pixels of characters with no pixel data are never read, so their offset does not matter
+bool character_pixels_in_bounds(const struct font_character *character, size_t pixel_data_size);
+
+// Checksum of a whole tag as it goes in the header, in host byte order
+uint32_t font_tag_checksum(const uint8_t *tag_data, size_t tag_size);
+
+// Start writing a new font tag with everything up to the pixel data, which the caller writes next.
+// Character tables are built in character_tables (CHARACTER_TABLES_MAX_SIZE bytes), or left out if it is null.
+bool start_font_tag(struct tag_writer *writer, const char *output_path, const struct font_character *characters, uint32_t characters_count, size_t pixel_data_size, uint8_t *character_tables, struct stats *stats);
+
+// Write a tag with new characters and pixel data that keeps everything else from an existing tag, including its font base
+// fields and style font names. Character tables are rebuilt in character_tables, or left out if it is null.
+bool write_font_tag_from(const struct font_tag_layout *tag, const char *output_path, const struct font_character *characters, uint32_t characters_count,
+                         const uint8_t *pixel_data, size_t pixel_data_size, uint8_t *character_tables, struct stats *stats, size_t *tag_size);
+
+// Build a whole font tag in memory. Characters must be sorted by character with no duplicates, and pixels_offset is
+// relative to pixel_data. The pixels are laid out in character order, and with dedup identical bitmaps are stored once.
+// The new tag is allocated with malloc and belongs to the caller.
+bool build_font_tag(const struct font_character *characters, uint32_t characters_count, const uint8_t *pixel_data, size_t pixel_data_size,
+                    bool character_tables, bool dedup, uint8_t **tag_data, size_t *tag_size);
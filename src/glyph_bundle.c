@@ -0,0 +1,164 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glyph_bundle.h"
+
+bool glyph_bundle_open(struct glyph_bundle *bundle, const char *path) {
+    *bundle = (struct glyph_bundle){0};
+    if(!mapped_file_open(&bundle->file, path)) {
+        return false;
+    }
+
+    const uint8_t *data = bundle->file.data;
+    size_t size = bundle->file.size;
+    if(size < sizeof(struct glyph_bundle_header)) {
+        fprintf(stderr, "%s is too small to be a glyph bundle\n", path);
+        goto error;
+    }
+
+    const struct glyph_bundle_header *header = (const struct glyph_bundle_header *)data;
+    if(byteswap32(header->signature) != GLYPH_BUNDLE_SIGNATURE || byteswap16(header->version) != GLYPH_BUNDLE_VERSION) {
+        fprintf(stderr, "%s is not a valid glyph bundle\n", path);
+        goto error;
+    }
+
+    uint32_t character_count = byteswap32(header->character_count);
+    if(character_count == 0 || character_count > UINT16_MAX) {
+        fprintf(stderr, "%s has an invalid character count (%u)\n", path, character_count);
+        goto error;
+    }
+
+    size_t characters_size = (size_t)character_count * sizeof(struct font_character);
+    size_t pixels_size = byteswap32(header->pixels_size);
+    if(size != sizeof(struct glyph_bundle_header) + characters_size + pixels_size) {
+        fprintf(stderr, "%s is truncated or has trailing data\n", path);
+        goto error;
+    }
+
+    bundle->characters = (const struct font_character *)(data + sizeof(struct glyph_bundle_header));
+    bundle->character_count = character_count;
+    bundle->pixels = data + sizeof(struct glyph_bundle_header) + characters_size;
+    bundle->pixels_size = pixels_size;
+
+    // Index must be sorted for lookups, and every character must point inside the pixel data
+    for(uint32_t i = 0; i < character_count; i++) {
+        const struct font_character *character = &bundle->characters[i];
+        if(i > 0 && byteswap16(character->character) <= byteswap16(bundle->characters[i - 1].character)) {
+            fprintf(stderr, "%s has unsorted or duplicate character %u\n", path, byteswap16(character->character));
+            goto error;
+        }
+
+        size_t character_pixels_size = calculate_pixels_size(byteswap16(character->bitmap_width), byteswap16(character->bitmap_height));
+        size_t character_pixels_offset = byteswap32(character->pixels_offset);
+        if(character_pixels_size > pixels_size || character_pixels_offset > pixels_size - character_pixels_size) {
+            fprintf(stderr, "Pixel data for character %u in %s is out of bounds\n", byteswap16(character->character), path);
+            goto error;
+        }
+    }
+
+    return true;
+
+    error:
+    glyph_bundle_close(bundle);
+    return false;
+}
+
+void glyph_bundle_close(struct glyph_bundle *bundle) {
+    mapped_file_close(&bundle->file);
+    *bundle = (struct glyph_bundle){0};
+}
+
+const struct font_character *glyph_bundle_find(const struct glyph_bundle *bundle, uint16_t character) {
+    size_t low = 0;
+    size_t high = bundle->character_count;
+    while(low < high) {
+        size_t middle = low + (high - low) / 2;
+        uint16_t middle_character = byteswap16(bundle->characters[middle].character);
+        if(middle_character == character) {
+            return &bundle->characters[middle];
+        }
+        else if(middle_character < character) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return nullptr;
+}
+
+const uint8_t *glyph_bundle_pixels(const struct glyph_bundle *bundle, const struct font_character *character) {
+    return bundle->pixels + byteswap32(character->pixels_offset);
+}
+
+bool glyph_bundle_write(const char *path, const struct font_character *characters, uint32_t character_count, const uint8_t *pixels) {
+    // A bundle with nothing in it could never be read back
+    if(character_count == 0 || character_count > UINT16_MAX) {
+        fprintf(stderr, "A glyph bundle needs 1 to %u characters, not %u\n", UINT16_MAX, character_count);
+        return false;
+    }
+
+    size_t characters_size = (size_t)character_count * sizeof(struct font_character);
+    struct font_character *characters_out = malloc(characters_size);
+    if(!characters_out) {
+        fprintf(stderr, "Could not allocate %zu bytes for glyph bundle index\n", characters_size);
+        return false;
+    }
+
+    // Pack pixel data in index order
+    size_t pixels_size = 0;
+    for(uint32_t i = 0; i < character_count; i++) {
+        characters_out[i] = characters[i];
+        characters_out[i].pixels_offset = byteswap32(pixels_size);
+        pixels_size += calculate_pixels_size(byteswap16(characters[i].bitmap_width), byteswap16(characters[i].bitmap_height));
+    }
+
+    if(pixels_size > UINT32_MAX) {
+        fprintf(stderr, "Too much pixel data for a glyph bundle (%zu bytes)\n", pixels_size);
+        free(characters_out);
+        return false;
+    }
+
+    struct glyph_bundle_header header = {0};
+    header.signature = byteswap32(GLYPH_BUNDLE_SIGNATURE);
+    header.version = byteswap16(GLYPH_BUNDLE_VERSION);
+    header.character_count = byteswap32(character_count);
+    header.pixels_size = byteswap32(pixels_size);
+
+    FILE *file_out = fopen(path, "wb");
+    if(!file_out) {
+        fprintf(stderr, "Could not open %s for writing\n", path);
+        free(characters_out);
+        return false;
+    }
+
+    // Pixel data is written a glyph at a time, so give stdio room to batch it
+    setvbuf(file_out, nullptr, _IOFBF, 1 * 1024 * 1024);
+
+    bool success = fwrite(&header, sizeof(header), 1, file_out) == 1 && fwrite(characters_out, characters_size, 1, file_out) == 1;
+    for(uint32_t i = 0; success && i < character_count; i++) {
+        size_t character_pixels_size = calculate_pixels_size(byteswap16(characters[i].bitmap_width), byteswap16(characters[i].bitmap_height));
+        if(character_pixels_size != 0) {
+            success = fwrite(pixels + byteswap32(characters[i].pixels_offset), character_pixels_size, 1, file_out) == 1;
+        }
+    }
+
+    if(fclose(file_out) != 0) {
+        success = false;
+    }
+
+    // Don't leave a truncated bundle behind
+    if(!success) {
+        fprintf(stderr, "Could not write glyph bundle to %s\n", path);
+        remove(path);
+    }
+
+    free(characters_out);
+
+    return success;
+}
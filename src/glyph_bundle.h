@@ -0,0 +1,46 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "font.h"
+#include "mapped_file.h"
+
+// A single file alternative to a directory of character files:
+//   header, font_character[character_count] sorted by character, pixel data
+// Everything is big endian like a tag. pixels_offset is relative to the start of the pixel data.
+enum {
+    GLYPH_BUNDLE_SIGNATURE = 0x66736762, // 'fsgb'
+    GLYPH_BUNDLE_VERSION = 1
+};
+
+struct glyph_bundle_header {
+    uint32_t signature;
+    uint16_t version;
+    char pad[2];
+    uint32_t character_count;
+    uint32_t pixels_size;
+};
+static_assert(sizeof(struct glyph_bundle_header) == 16);
+
+struct glyph_bundle {
+    struct mapped_file file;
+    const struct font_character *characters;
+    uint32_t character_count;
+    const uint8_t *pixels;
+    size_t pixels_size;
+};
+
+// Map and validate a bundle
+bool glyph_bundle_open(struct glyph_bundle *bundle, const char *path);
+void glyph_bundle_close(struct glyph_bundle *bundle);
+
+// Binary search for a character. Returns nullptr if the bundle does not have it.
+const struct font_character *glyph_bundle_find(const struct glyph_bundle *bundle, uint16_t character);
+const uint8_t *glyph_bundle_pixels(const struct glyph_bundle *bundle, const struct font_character *character);
+
+// Write a bundle. characters must be sorted with no duplicates, and their pixels_offset
+// values are relative to pixels. Pixel data is packed in character order. Nothing is left at path if it fails.
+bool glyph_bundle_write(const char *path, const struct font_character *characters, uint32_t character_count, const uint8_t *pixels);
@@ -0,0 +1,230 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glyph_set.h"
+
+// Both of these are always there on the CPUs they are for, so there is nothing to detect
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define GLYPH_SET_HAVE_SSE2
+    #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define GLYPH_SET_HAVE_NEON
+    #include <arm_neon.h>
+#endif
+
+// Characters are converted through a buffer of this many at a time, which stays in L1
+#define GLYPH_SET_BLOCK 256
+#define CHARACTER_WORDS (sizeof(struct font_character) / sizeof(uint16_t))
+
+// Every field of a character is 16-bit except pixels_offset, which is two words with the high one first.
+// Swapping the bytes of every word is all it takes to get each field in host order.
+static void byteswap_words(uint16_t *out, const uint8_t *in, size_t count) {
+    size_t i = 0;
+#if defined(GLYPH_SET_HAVE_SSE2)
+    for(; i + 8 <= count; i += 8) {
+        __m128i words = _mm_loadu_si128((const __m128i *)(in + i * 2));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_or_si128(_mm_slli_epi16(words, 8), _mm_srli_epi16(words, 8)));
+    }
+#elif defined(GLYPH_SET_HAVE_NEON)
+    for(; i + 8 <= count; i += 8) {
+        vst1q_u16(out + i, vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(in + i * 2))));
+    }
+#endif
+    for(; i < count; i++) {
+        out[i] = ((uint16_t)in[i * 2] << 8) | in[i * 2 + 1];
+    }
+}
+
+// Add the characters of a set to metrics that have already been started
+static void accumulate_metrics(const struct glyph_set *set, struct glyph_metrics *metrics) {
+    int16_t max_ascending_height = metrics->max_ascending_height;
+    int16_t max_descending_height = metrics->max_descending_height;
+    size_t pixels_size = 0;
+    uint32_t i = 0;
+
+    // Ascending height works out to bitmap_origin_y, and descending height to bitmap_height - bitmap_origin_y.
+    // A pixel size is at most 32767 * 32767, so two of them still fit in 32 bits.
+#if defined(GLYPH_SET_HAVE_SSE2)
+    __m128i zero = _mm_setzero_si128();
+    __m128i ascending = _mm_set1_epi16(max_ascending_height);
+    __m128i descending = _mm_set1_epi16(max_descending_height);
+    __m128i sizes = zero;
+    for(; i + 8 <= set->count; i += 8) {
+        __m128i width = _mm_loadu_si128((const __m128i *)(set->bitmap_width + i));
+        __m128i height = _mm_loadu_si128((const __m128i *)(set->bitmap_height + i));
+        __m128i origin_y = _mm_loadu_si128((const __m128i *)(set->bitmap_origin_y + i));
+        ascending = _mm_max_epi16(ascending, origin_y);
+        descending = _mm_max_epi16(descending, _mm_sub_epi16(height, origin_y));
+
+        __m128i products = _mm_madd_epi16(_mm_max_epi16(width, zero), _mm_max_epi16(height, zero));
+        sizes = _mm_add_epi64(sizes, _mm_unpacklo_epi32(products, zero));
+        sizes = _mm_add_epi64(sizes, _mm_unpackhi_epi32(products, zero));
+    }
+
+    int16_t ascending_lanes[8];
+    int16_t descending_lanes[8];
+    uint64_t size_lanes[2];
+    _mm_storeu_si128((__m128i *)ascending_lanes, ascending);
+    _mm_storeu_si128((__m128i *)descending_lanes, descending);
+    _mm_storeu_si128((__m128i *)size_lanes, sizes);
+    for(int lane = 0; lane < 8; lane++) {
+        if(ascending_lanes[lane] > max_ascending_height) {
+            max_ascending_height = ascending_lanes[lane];
+        }
+        if(descending_lanes[lane] > max_descending_height) {
+            max_descending_height = descending_lanes[lane];
+        }
+    }
+    pixels_size = size_lanes[0] + size_lanes[1];
+#elif defined(GLYPH_SET_HAVE_NEON)
+    int16x8_t zero = vdupq_n_s16(0);
+    int16x8_t ascending = vdupq_n_s16(max_ascending_height);
+    int16x8_t descending = vdupq_n_s16(max_descending_height);
+    uint64x2_t sizes = vdupq_n_u64(0);
+    for(; i + 8 <= set->count; i += 8) {
+        int16x8_t width = vmaxq_s16(vld1q_s16(set->bitmap_width + i), zero);
+        int16x8_t height = vld1q_s16(set->bitmap_height + i);
+        int16x8_t origin_y = vld1q_s16(set->bitmap_origin_y + i);
+        ascending = vmaxq_s16(ascending, origin_y);
+        descending = vmaxq_s16(descending, vsubq_s16(height, origin_y));
+
+        height = vmaxq_s16(height, zero);
+        sizes = vpadalq_u32(sizes, vreinterpretq_u32_s32(vmull_s16(vget_low_s16(width), vget_low_s16(height))));
+        sizes = vpadalq_u32(sizes, vreinterpretq_u32_s32(vmull_s16(vget_high_s16(width), vget_high_s16(height))));
+    }
+
+    max_ascending_height = vmaxvq_s16(ascending);
+    max_descending_height = vmaxvq_s16(descending);
+    pixels_size = vaddvq_u64(sizes);
+#endif
+
+    for(; i < set->count; i++) {
+        int16_t descending_height = set->bitmap_height[i] - set->bitmap_origin_y[i];
+        if(set->bitmap_origin_y[i] > max_ascending_height) {
+            max_ascending_height = set->bitmap_origin_y[i];
+        }
+        if(descending_height > max_descending_height) {
+            max_descending_height = descending_height;
+        }
+        pixels_size += glyph_set_pixels_size(set, i);
+    }
+
+    metrics->max_ascending_height = max_ascending_height;
+    metrics->max_descending_height = max_descending_height;
+    metrics->pixels_size += pixels_size;
+}
+
+// Decode characters into set at first. There can be at most GLYPH_SET_BLOCK of them.
+static void decode_block(struct glyph_set *set, uint32_t first, const struct font_character *characters, uint32_t characters_count) {
+    uint16_t words[GLYPH_SET_BLOCK * CHARACTER_WORDS];
+    byteswap_words(words, (const uint8_t *)characters, characters_count * CHARACTER_WORDS);
+
+    for(uint32_t i = 0; i < characters_count; i++) {
+        const uint16_t *character = &words[i * CHARACTER_WORDS];
+        set->character[first + i] = character[0];
+        set->character_width[first + i] = (int16_t)character[1];
+        set->bitmap_width[first + i] = (int16_t)character[2];
+        set->bitmap_height[first + i] = (int16_t)character[3];
+        set->bitmap_origin_x[first + i] = (int16_t)character[4];
+        set->bitmap_origin_y[first + i] = (int16_t)character[5];
+        set->hardware_character_index[first + i] = character[6];
+        set->pixels_offset[first + i] = ((uint32_t)character[8] << 16) | character[9];
+    }
+}
+
+bool glyph_set_init(struct glyph_set *set, uint32_t capacity) {
+    *set = (struct glyph_set){0};
+
+    // One allocation for every array, with the 32-bit one first so they all stay aligned
+    uint8_t *arrays = malloc((size_t)capacity * (sizeof(uint32_t) + 7 * sizeof(uint16_t)) + 1);
+    if(!arrays) {
+        fprintf(stderr, "Could not allocate a glyph set for %u characters\n", capacity);
+        return false;
+    }
+
+    set->capacity = capacity;
+    set->pixels_offset = (uint32_t *)arrays;
+    arrays += capacity * sizeof(uint32_t);
+    set->character = (uint16_t *)arrays;
+    set->character_width = (int16_t *)(arrays + capacity * sizeof(uint16_t));
+    set->bitmap_width = (int16_t *)(arrays + capacity * sizeof(uint16_t) * 2);
+    set->bitmap_height = (int16_t *)(arrays + capacity * sizeof(uint16_t) * 3);
+    set->bitmap_origin_x = (int16_t *)(arrays + capacity * sizeof(uint16_t) * 4);
+    set->bitmap_origin_y = (int16_t *)(arrays + capacity * sizeof(uint16_t) * 5);
+    set->hardware_character_index = (uint16_t *)(arrays + capacity * sizeof(uint16_t) * 6);
+
+    return true;
+}
+
+void glyph_set_free(struct glyph_set *set) {
+    free(set->pixels_offset);
+    *set = (struct glyph_set){0};
+}
+
+void glyph_set_decode(struct glyph_set *set, const struct font_character *characters, uint32_t characters_count) {
+    if(characters_count > set->capacity) {
+        characters_count = set->capacity;
+    }
+
+    for(uint32_t first = 0; first < characters_count; first += GLYPH_SET_BLOCK) {
+        uint32_t count = characters_count - first < GLYPH_SET_BLOCK ? characters_count - first : GLYPH_SET_BLOCK;
+        decode_block(set, first, characters + first, count);
+    }
+
+    set->count = characters_count;
+}
+
+void glyph_set_encode(const struct glyph_set *set, struct font_character *characters) {
+    uint16_t words[GLYPH_SET_BLOCK * CHARACTER_WORDS];
+    for(uint32_t first = 0; first < set->count; first += GLYPH_SET_BLOCK) {
+        uint32_t count = set->count - first < GLYPH_SET_BLOCK ? set->count - first : GLYPH_SET_BLOCK;
+        for(uint32_t i = 0; i < count; i++) {
+            uint16_t *character = &words[i * CHARACTER_WORDS];
+            character[0] = set->character[first + i];
+            character[1] = (uint16_t)set->character_width[first + i];
+            character[2] = (uint16_t)set->bitmap_width[first + i];
+            character[3] = (uint16_t)set->bitmap_height[first + i];
+            character[4] = (uint16_t)set->bitmap_origin_x[first + i];
+            character[5] = (uint16_t)set->bitmap_origin_y[first + i];
+            character[6] = set->hardware_character_index[first + i];
+            character[7] = 0;
+            character[8] = set->pixels_offset[first + i] >> 16;
+            character[9] = set->pixels_offset[first + i] & 0xFFFF;
+        }
+
+        // Swapping is its own inverse, so the same kernel writes them back out
+        byteswap_words((uint16_t *)(characters + first), (const uint8_t *)words, count * CHARACTER_WORDS);
+    }
+}
+
+void glyph_set_metrics(const struct glyph_set *set, struct glyph_metrics *metrics) {
+    *metrics = (struct glyph_metrics){ .max_ascending_height = 1, .max_descending_height = 1 };
+    accumulate_metrics(set, metrics);
+}
+
+void font_characters_metrics(const struct font_character *characters, uint32_t characters_count, struct glyph_metrics *metrics) {
+    uint32_t pixels_offset[GLYPH_SET_BLOCK];
+    uint16_t fields[7][GLYPH_SET_BLOCK];
+    struct glyph_set block = {
+        .capacity = GLYPH_SET_BLOCK,
+        .character = fields[0],
+        .character_width = (int16_t *)fields[1],
+        .bitmap_width = (int16_t *)fields[2],
+        .bitmap_height = (int16_t *)fields[3],
+        .bitmap_origin_x = (int16_t *)fields[4],
+        .bitmap_origin_y = (int16_t *)fields[5],
+        .hardware_character_index = fields[6],
+        .pixels_offset = pixels_offset
+    };
+
+    *metrics = (struct glyph_metrics){ .max_ascending_height = 1, .max_descending_height = 1 };
+    for(uint32_t first = 0; first < characters_count; first += GLYPH_SET_BLOCK) {
+        block.count = characters_count - first < GLYPH_SET_BLOCK ? characters_count - first : GLYPH_SET_BLOCK;
+        decode_block(&block, 0, characters + first, block.count);
+        accumulate_metrics(&block, metrics);
+    }
+}
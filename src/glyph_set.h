@@ -0,0 +1,51 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "font.h"
+
+// Characters in host byte order with one array per field, so loops over a field only touch that field
+struct glyph_set {
+    uint32_t count;
+    uint32_t capacity;
+    uint16_t *character;
+    int16_t *character_width;
+    int16_t *bitmap_width;
+    int16_t *bitmap_height;
+    int16_t *bitmap_origin_x;
+    int16_t *bitmap_origin_y;
+    uint16_t *hardware_character_index;
+    uint32_t *pixels_offset;
+};
+
+// What a font base needs to know about its characters
+struct glyph_metrics {
+    int16_t max_ascending_height;
+    int16_t max_descending_height;
+    size_t pixels_size; // total pixels of every character, counting shared pixel data once per character
+};
+
+bool glyph_set_init(struct glyph_set *set, uint32_t capacity);
+void glyph_set_free(struct glyph_set *set);
+
+// Convert tag characters to and from a glyph set. Padding is not kept and is written as zero.
+void glyph_set_decode(struct glyph_set *set, const struct font_character *characters, uint32_t characters_count);
+void glyph_set_encode(const struct glyph_set *set, struct font_character *characters);
+
+void glyph_set_metrics(const struct glyph_set *set, struct glyph_metrics *metrics);
+
+// Same as decoding into a glyph set and getting its metrics, but a block at a time so nothing is allocated
+void font_characters_metrics(const struct font_character *characters, uint32_t characters_count, struct glyph_metrics *metrics);
+
+static inline size_t glyph_set_pixels_size(const struct glyph_set *set, uint32_t index) {
+    return calculate_pixels_size(set->bitmap_width[index], set->bitmap_height[index]);
+}
+
+// Pixels of characters with no pixel data are never read, so their offset does not matter
+static inline bool glyph_set_pixels_in_bounds(const struct glyph_set *set, uint32_t index, size_t pixel_data_size) {
+    size_t pixels_size = glyph_set_pixels_size(set, index);
+    return pixels_size == 0 || (pixels_size <= pixel_data_size && set->pixels_offset[index] <= pixel_data_size - pixels_size);
+}
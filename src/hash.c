@@ -0,0 +1,50 @@
+// Font Slicer, by Aerocatia
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "hash.h"
+
+#define HASH_PRIME_1 0x9E3779B97F4A7C15ULL
+#define HASH_PRIME_2 0xC2B2AE3D27D4EB4FULL
+
+static uint64_t hash_mix(uint64_t value) {
+    value ^= value >> 33;
+    value *= HASH_PRIME_2;
+    value ^= value >> 29;
+    value *= HASH_PRIME_1;
+    value ^= value >> 32;
+    return value;
+}
+
+static uint64_t read64le(const uint8_t *p) {
+    uint64_t value = 0;
+    for(int i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+uint64_t hash64(const void *data, size_t size, uint64_t seed) {
+    const uint8_t *p = data;
+    uint64_t hash = seed ^ (size * HASH_PRIME_1);
+
+    // Two independent lanes so the multiplies can overlap
+    uint64_t lane = hash_mix(seed + HASH_PRIME_2);
+    while(size >= 16) {
+        hash = (hash ^ read64le(p)) * HASH_PRIME_1;
+        hash ^= hash >> 31;
+        lane = (lane ^ read64le(p + 8)) * HASH_PRIME_2;
+        lane ^= lane >> 29;
+        p += 16;
+        size -= 16;
+    }
+
+    uint8_t tail[16] = {0};
+    memcpy(tail, p, size);
+    hash = (hash ^ read64le(tail)) * HASH_PRIME_1;
+    lane = (lane ^ read64le(tail + 8)) * HASH_PRIME_2;
+
+    return hash_mix(hash ^ hash_mix(lane) ^ size);
+}
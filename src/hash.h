@@ -0,0 +1,9 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Fast 64-bit content hash. Not cryptographic; compare the bytes too if a collision would matter.
+uint64_t hash64(const void *data, size_t size, uint64_t seed);
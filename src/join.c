@@ -0,0 +1,821 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "character_dir.h"
+#include "character_rle.h"
+#include "character_tar.h"
+#include "font_tag.h"
+#include "glyph_bundle.h"
+#include "glyph_set.h"
+#include "hash.h"
+#include "join.h"
+#include "join_index.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "pixel_pack.h"
+#include "stats.h"
+#include "tag_writer.h"
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#endif
+
+// Messages go to stderr when the tag itself is going to stdout
+static FILE *join_messages(const char *output_path) {
+    return strcmp(output_path, "-") == 0 ? stderr : stdout;
+}
+
+// Write a new font tag from sorted characters, storing identical bitmaps once.
+// pixels_offset of each character is relative to pixel_data, and is rewritten.
+static bool write_deduplicated_font_tag(const char *output_path, struct font_character *characters, uint32_t characters_count, const uint8_t *pixel_data, uint8_t *character_tables, struct stats *stats) {
+    struct glyph_metrics metrics;
+    font_characters_metrics(characters, characters_count, &metrics);
+    size_t pixel_data_size = metrics.pixels_size;
+
+    uint8_t *packed_pixel_data = malloc(pixel_data_size ? pixel_data_size : 1);
+    if(!packed_pixel_data) {
+        fprintf(stderr, "Could not allocate %zu bytes for pixel data\n", pixel_data_size);
+        return false;
+    }
+
+    stats_phase(stats, "pack");
+    struct pixel_pack_result packed;
+    struct tag_writer writer;
+    bool success = pack_pixels(characters, characters_count, pixel_data, packed_pixel_data, true, &packed);
+    stats_phase(stats, "write");
+    success = success && start_font_tag(&writer, output_path, characters, characters_count, packed.pixels_size, character_tables, stats);
+    if(success) {
+        tag_writer_write(&writer, packed_pixel_data, packed.pixels_size);
+        success = tag_writer_close(&writer);
+    }
+
+    if(success) {
+        fprintf(join_messages(output_path), "%s: %u characters share pixel data with another character, saving %zu bytes\n", output_path, packed.shared_characters, packed.bytes_saved);
+    }
+
+    free(packed_pixel_data);
+
+    return success;
+}
+
+// Pixel data is read in windows of at least this much, and written while the next window is read
+#define JOIN_WINDOW_SIZE (4 * 1024 * 1024)
+
+struct join_context {
+    const struct character_dir *dir;
+    struct stats *stats;
+    const uint16_t *character_files;
+    struct font_character *characters;
+    size_t *pixels_offsets;
+};
+
+struct join_window {
+    const struct join_context *join;
+    uint32_t first;
+    uint32_t last;
+    uint8_t *pixels;
+};
+
+// Read the character struct of character files [first, last) and check their size
+static bool join_read_characters(void *context, uint32_t first, uint32_t last) {
+    const struct join_context *join = context;
+
+    char path_buffer[512];
+    for(uint32_t i = first; i < last; i++) {
+        struct font_character *current_character = &join->characters[i];
+
+        // Open and get size. A compressed file's size is what it decompresses to.
+        struct character_file file_in;
+        if(!character_file_open(join->dir, join->character_files[i], &file_in)) {
+            return false;
+        }
+
+        if(file_in.size < sizeof(struct font_character)) {
+            character_dir_file_path(join->dir, join->character_files[i], path_buffer, sizeof(path_buffer));
+            fprintf(stderr, "%s is too small to be a font character\n", path_buffer);
+            character_file_close(&file_in);
+            return false;
+        }
+
+        // Read character struct
+        bool read = character_file_read_character(&file_in, current_character);
+        character_file_close(&file_in);
+        stats_count(join->stats, STATS_FILES_OPENED, 1);
+        stats_count(join->stats, STATS_BYTES_READ, file_in.compressed ? sizeof(struct character_rle_header) : sizeof(struct font_character));
+        if(!read) {
+            character_dir_file_path(join->dir, join->character_files[i], path_buffer, sizeof(path_buffer));
+            fprintf(stderr, "Could not read character data from %s\n", path_buffer);
+            return false;
+        }
+
+        // Check remaning file size matches what is expected
+        size_t pixels_size = calculate_pixels_size(byteswap16(current_character->bitmap_width), byteswap16(current_character->bitmap_height));
+        if(file_in.size != sizeof(struct font_character) + pixels_size) {
+            character_dir_file_path(join->dir, join->character_files[i], path_buffer, sizeof(path_buffer));
+            fprintf(stderr, "pixel data size for %s is invalid\n", path_buffer);
+            return false;
+        }
+
+        // Filled in with the real offsets once every size is known
+        join->pixels_offsets[i + 1] = pixels_size;
+    }
+
+    return true;
+}
+
+// Read the pixels of the window's character files [first, last) into the window
+static bool join_read_pixels(void *context, uint32_t first, uint32_t last) {
+    const struct join_window *window = context;
+    const struct join_context *join = window->join;
+    size_t window_offset = join->pixels_offsets[window->first];
+
+    char path_buffer[512];
+    for(uint32_t i = window->first + first; i < window->first + last; i++) {
+        size_t pixels_size = join->pixels_offsets[i + 1] - join->pixels_offsets[i];
+        if(pixels_size == 0) {
+            continue;
+        }
+
+        struct character_file file_in;
+        if(!character_file_open(join->dir, join->character_files[i], &file_in)) {
+            return false;
+        }
+
+        bool read = file_in.size == sizeof(struct font_character) + pixels_size &&
+                    character_file_read_pixels(&file_in, window->pixels + join->pixels_offsets[i] - window_offset, pixels_size);
+        character_file_close(&file_in);
+        stats_count(join->stats, STATS_FILES_OPENED, 1);
+        stats_count(join->stats, STATS_BYTES_READ, file_in.compressed ? file_in.file_size - sizeof(struct character_rle_header) : pixels_size);
+        if(!read) {
+            character_dir_file_path(join->dir, join->character_files[i], path_buffer, sizeof(path_buffer));
+            fprintf(stderr, "Could not read pixels from %s\n", path_buffer);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Take as many characters from first as fit in the window
+static uint32_t join_window_end(const size_t *pixels_offsets, uint32_t first, uint32_t count, size_t window_size) {
+    uint32_t last = first;
+    while(last < count && pixels_offsets[last + 1] - pixels_offsets[first] <= window_size) {
+        last++;
+    }
+
+    return last;
+}
+
+// Stream the pixel data of every character file into the tag, a window at a time
+static bool join_write_pixels(struct tag_writer *writer, const struct join_context *join, uint32_t count, unsigned jobs, struct workspace *workspace) {
+    // A window has to fit the largest character
+    size_t window_size = JOIN_WINDOW_SIZE;
+    for(uint32_t i = 0; i < count; i++) {
+        size_t pixels_size = join->pixels_offsets[i + 1] - join->pixels_offsets[i];
+        if(pixels_size > window_size) {
+            window_size = pixels_size;
+        }
+    }
+
+    if(!workspace_reserve_pixel_windows(workspace, window_size)) {
+        return false;
+    }
+
+    struct join_window windows[2] = {
+        { .join = join, .pixels = workspace->pixel_windows[0] },
+        { .join = join, .pixels = workspace->pixel_windows[1] }
+    };
+    struct parallel_task *task = &workspace->task;
+
+    int current = 0;
+    windows[current].first = 0;
+    windows[current].last = join_window_end(join->pixels_offsets, 0, count, window_size);
+    parallel_start(task, jobs, windows[current].last, join_read_pixels, &windows[current]);
+
+    bool success = true;
+    while(true) {
+        if(!parallel_finish(task)) {
+            success = false;
+            break;
+        }
+
+        // Start reading the next window before writing this one
+        const struct join_window *done = &windows[current];
+        bool more = done->last < count;
+        if(more) {
+            current ^= 1;
+            windows[current].first = done->last;
+            windows[current].last = join_window_end(join->pixels_offsets, done->last, count, window_size);
+            parallel_start(task, jobs, windows[current].last - windows[current].first, join_read_pixels, &windows[current]);
+        }
+
+        if(!tag_writer_write(writer, done->pixels, join->pixels_offsets[done->last] - join->pixels_offsets[done->first])) {
+            if(more) {
+                parallel_finish(task);
+            }
+            success = false;
+            break;
+        }
+
+        if(!more) {
+            break;
+        }
+    }
+
+    return success;
+}
+
+// Where a character's pixels come from in an incremental join
+struct incremental_source {
+    bool changed; // read from its file this time, otherwise copied from the previous tag
+    size_t offset;
+};
+
+// Rebuild a tag reading only the character files that changed since the index saved with it.
+// Unchanged characters are copied from the previous tag.
+static bool join_incrementally(const struct character_dir *dir, const char *output_path, const uint16_t *character_files, int character_files_count, uint8_t *character_tables, struct workspace *workspace) {
+    size_t output_path_length = strlen(output_path);
+    char *index_path = malloc(output_path_length + sizeof(".index"));
+    char *temp_path = malloc(output_path_length + sizeof(".tmp"));
+    struct join_index_entry *entries = malloc(character_files_count * sizeof(struct join_index_entry));
+    struct incremental_source *sources = malloc(character_files_count * sizeof(struct incremental_source));
+    uint8_t *changed_pixels = nullptr;
+    size_t changed_pixels_size = 0;
+    size_t changed_pixels_capacity = 0;
+    bool success = false;
+
+    struct join_index old_index = {0};
+    struct mapped_file old_tag = {0};
+    const uint8_t *old_pixel_data = nullptr;
+    size_t old_pixel_data_size = 0;
+
+    if(!index_path || !temp_path || !entries || !sources) {
+        fprintf(stderr, "Could not allocate incremental join buffers\n");
+        goto cleanup;
+    }
+
+    snprintf(index_path, output_path_length + sizeof(".index"), "%s.index", output_path);
+    snprintf(temp_path, output_path_length + sizeof(".tmp"), "%s.tmp", output_path);
+
+    // The previous tag can only be reused if it is exactly the one the index describes
+    stats_phase(workspace->stats, "check_files");
+    int64_t scan_time = join_index_now();
+    struct stat st;
+    if(join_index_load(&old_index, index_path) && stat(output_path, &st) == 0 && mapped_file_open(&old_tag, output_path)) {
+        const struct tag_header *old_header = (const struct tag_header *)old_tag.data;
+        struct font_tag_layout old_layout;
+        if(old_tag.size == old_index.header.tag_size && old_tag.size >= sizeof(struct tag_header) && byteswap32(old_header->checksum) == old_index.header.tag_checksum &&
+           read_font_tag_layout(output_path, old_tag.data, old_tag.size, &old_layout) && old_layout.characters_count == old_index.header.entries_count) {
+            old_pixel_data = old_layout.pixel_data;
+            old_pixel_data_size = old_layout.pixel_data_size;
+        }
+        else {
+            fprintf(stderr, "Warning: %s has changed since it was indexed, rebuilding it\n", output_path);
+        }
+    }
+
+    // Check every file against the index
+    char path_buffer[512];
+    size_t reused_count = 0;
+    for(int i = 0; i < character_files_count; i++) {
+        struct join_index_entry *entry = &entries[i];
+        character_dir_file_path(dir, character_files[i], path_buffer, sizeof(path_buffer));
+        if(character_dir_stat(dir, character_files[i], &st) == -1) {
+            fprintf(stderr, "Failed to open %s\n", path_buffer);
+            goto cleanup;
+        }
+
+        *entry = (struct join_index_entry) {
+            .file_size = st.st_size,
+            .file_mtime = join_index_mtime(&st)
+        };
+
+        // Files touched during the last scan could have changed again without a new mtime, so they are always read
+        const struct join_index_entry *old_entry = old_pixel_data ? join_index_find(&old_index, character_files[i]) : nullptr;
+        if(old_entry) {
+            size_t old_pixels_size = calculate_pixels_size(byteswap16(old_entry->character.bitmap_width), byteswap16(old_entry->character.bitmap_height));
+            size_t old_pixels_offset = byteswap32(old_entry->character.pixels_offset);
+            if(old_pixels_size > old_pixel_data_size || old_pixels_offset > old_pixel_data_size - old_pixels_size) {
+                old_entry = nullptr;
+            }
+        }
+
+        if(old_entry && old_entry->file_size == entry->file_size && old_entry->file_mtime == entry->file_mtime && old_entry->file_mtime < old_index.header.scan_time) {
+            entry->character = old_entry->character;
+            entry->file_hash = old_entry->file_hash;
+            sources[i] = (struct incremental_source){ .changed = false, .offset = byteswap32(old_entry->character.pixels_offset) };
+            reused_count++;
+            continue;
+        }
+
+        // Read the whole file
+        struct character_file file_in;
+        if(!character_file_open(dir, character_files[i], &file_in)) {
+            goto cleanup;
+        }
+
+        if(file_in.size < sizeof(struct font_character)) {
+            fprintf(stderr, "%s is too small to be a font character\n", path_buffer);
+            character_file_close(&file_in);
+            goto cleanup;
+        }
+
+        // The character struct says how big the pixels are, so check it before anything is allocated for them
+        size_t pixels_size = file_in.size - sizeof(struct font_character);
+        if(file_in.file_size != (size_t)st.st_size || !character_file_read_character(&file_in, &entry->character)) {
+            fprintf(stderr, "Could not read character data from %s\n", path_buffer);
+            character_file_close(&file_in);
+            goto cleanup;
+        }
+
+        if(calculate_pixels_size(byteswap16(entry->character.bitmap_width), byteswap16(entry->character.bitmap_height)) != pixels_size) {
+            fprintf(stderr, "pixel data size for %s is invalid\n", path_buffer);
+            character_file_close(&file_in);
+            goto cleanup;
+        }
+
+        if(changed_pixels_size + pixels_size > changed_pixels_capacity) {
+            size_t new_capacity = changed_pixels_capacity ? changed_pixels_capacity * 2 : 64 * 1024;
+            while(new_capacity < changed_pixels_size + pixels_size) {
+                new_capacity *= 2;
+            }
+
+            uint8_t *new_changed_pixels = realloc(changed_pixels, new_capacity);
+            if(!new_changed_pixels) {
+                fprintf(stderr, "Could not allocate %zu bytes for changed pixel data\n", new_capacity);
+                character_file_close(&file_in);
+                goto cleanup;
+            }
+
+            changed_pixels = new_changed_pixels;
+            changed_pixels_capacity = new_capacity;
+        }
+
+        bool read = character_file_read_pixels(&file_in, changed_pixels + changed_pixels_size, pixels_size);
+        character_file_close(&file_in);
+        stats_count(workspace->stats, STATS_FILES_OPENED, 1);
+        stats_count(workspace->stats, STATS_BYTES_READ, file_in.file_size);
+        if(!read) {
+            fprintf(stderr, "Could not read character data from %s\n", path_buffer);
+            goto cleanup;
+        }
+
+        // Make sure the character we just loaded is set correctly
+        uint16_t old_char = byteswap16(entry->character.character);
+        if(character_files[i] != old_char) {
+            printf("%s: importing internal character %u as %u\n", path_buffer, old_char, character_files[i]);
+            entry->character.character = byteswap16(character_files[i]);
+        }
+
+        entry->file_hash = hash64(&entry->character, sizeof(struct font_character), hash64(changed_pixels + changed_pixels_size, pixels_size, 0));
+
+        // Touched but not changed
+        if(old_entry && old_entry->file_hash == entry->file_hash && old_entry->file_size == entry->file_size) {
+            entry->character = old_entry->character;
+            sources[i] = (struct incremental_source){ .changed = false, .offset = byteswap32(old_entry->character.pixels_offset) };
+            reused_count++;
+            continue;
+        }
+
+        sources[i] = (struct incremental_source){ .changed = true, .offset = changed_pixels_size };
+        changed_pixels_size += pixels_size;
+    }
+
+    // Lay out the new tag
+    struct font_character *characters = workspace->characters;
+    size_t *pixels_offsets = workspace->pixels_offsets;
+    pixels_offsets[0] = 0;
+    for(int i = 0; i < character_files_count; i++) {
+        characters[i] = entries[i].character;
+        size_t pixels_size = calculate_pixels_size(byteswap16(characters[i].bitmap_width), byteswap16(characters[i].bitmap_height));
+        pixels_offsets[i + 1] = pixels_offsets[i] + pixels_size;
+
+        // This is always set to the current position, even if there are no pixels
+        characters[i].pixels_offset = byteswap32(pixels_offsets[i]);
+        entries[i].character = characters[i];
+
+        if(pixels_size == 0) {
+            fprintf(stderr, "Warning: character %u has no pixel data\n", character_files[i]);
+            stats_count(workspace->stats, STATS_EMPTY_GLYPHS, 1);
+        }
+    }
+
+    // Write next to the old tag, which is still being read from
+    stats_phase(workspace->stats, "write");
+    struct tag_writer writer;
+    if(!start_font_tag(&writer, temp_path, characters, character_files_count, pixels_offsets[character_files_count], character_tables, workspace->stats)) {
+        goto cleanup;
+    }
+
+    for(int i = 0; i < character_files_count; i++) {
+        const uint8_t *pixels = sources[i].changed ? changed_pixels + sources[i].offset : old_pixel_data + sources[i].offset;
+        tag_writer_write(&writer, pixels, pixels_offsets[i + 1] - pixels_offsets[i]);
+    }
+
+    uint32_t new_checksum = writer.crc;
+    size_t new_size = writer.size;
+    if(!tag_writer_close(&writer)) {
+        goto cleanup;
+    }
+
+    mapped_file_close(&old_tag);
+#ifdef _WIN32
+    remove(output_path);
+#endif
+    if(rename(temp_path, output_path) != 0) {
+        fprintf(stderr, "Could not replace %s\n", output_path);
+        remove(temp_path);
+        goto cleanup;
+    }
+
+    // Index the tag just written
+    struct join_index new_index = {
+        .header = {
+            .signature = JOIN_INDEX_SIGNATURE,
+            .version = JOIN_INDEX_VERSION,
+            .entries_count = character_files_count,
+            .tag_checksum = new_checksum,
+            .tag_size = new_size,
+            .scan_time = scan_time
+        },
+        .entries = entries
+    };
+
+    stats_phase(workspace->stats, "save_index");
+    success = join_index_save(&new_index, index_path);
+    printf("%s: %zu of %d characters unchanged\n", output_path, reused_count, character_files_count);
+
+    cleanup:
+    mapped_file_close(&old_tag);
+    join_index_free(&old_index);
+    free(changed_pixels);
+    free(sources);
+    free(entries);
+    free(temp_path);
+    free(index_path);
+
+    return success;
+}
+
+static bool join_character_dir(struct character_dir *dir, const char *output_path, const struct join_options *options, uint8_t *character_tables, struct workspace *workspace) {
+    unsigned jobs = options->jobs;
+    uint16_t *character_files = workspace->character_files;
+    int character_files_count = 0;
+    if(!character_dir_scan(dir, character_files, &character_files_count)) {
+        return false;
+    }
+
+    if(options->incremental) {
+        return join_incrementally(dir, output_path, character_files, character_files_count, character_tables, workspace);
+    }
+
+    // Read every character struct first. Pixel data is stored in character order, so each
+    // character's pixels_offset is the sum of the pixel sizes before it.
+    struct font_character *characters = workspace->characters;
+    size_t *pixels_offsets = workspace->pixels_offsets;
+
+    struct join_context join = {
+        .dir = dir,
+        .stats = workspace->stats,
+        .character_files = character_files,
+        .characters = characters,
+        .pixels_offsets = pixels_offsets
+    };
+
+    stats_phase(workspace->stats, "read_characters");
+    if(!parallel_for(jobs, character_files_count, join_read_characters, &join)) {
+        return false;
+    }
+
+    stats_phase(workspace->stats, "layout");
+    pixels_offsets[0] = 0;
+    for(int i = 0; i < character_files_count; i++) {
+        struct font_character *current_character = &characters[i];
+        pixels_offsets[i + 1] += pixels_offsets[i];
+
+        // This is always set to the current position, even if there are no pixels
+        current_character->pixels_offset = byteswap32(pixels_offsets[i]);
+
+        // Make sure the character we just loaded is set correctly
+        uint16_t old_char = byteswap16(current_character->character);
+        if(character_files[i] != old_char) {
+            char path[512];
+            character_dir_file_path(dir, character_files[i], path, sizeof(path));
+            fprintf(join_messages(output_path), "%s: importing internal character %u as %u\n", path, old_char, character_files[i]);
+            current_character->character = byteswap16(character_files[i]);
+        }
+
+        if(pixels_offsets[i + 1] == pixels_offsets[i]) {
+            fprintf(stderr, "Warning: character %u has no pixel data\n", character_files[i]);
+            stats_count(workspace->stats, STATS_EMPTY_GLYPHS, 1);
+        }
+    }
+
+    // Deduplicating needs every bitmap before the character array can be written, so read them all first
+    if(options->dedup) {
+        size_t pixel_data_size = pixels_offsets[character_files_count];
+        uint8_t *pixel_data = malloc(pixel_data_size ? pixel_data_size : 1);
+        if(!pixel_data) {
+            fprintf(stderr, "Could not allocate %zu bytes for pixel data\n", pixel_data_size);
+            return false;
+        }
+
+        struct join_window all = { .join = &join, .first = 0, .last = character_files_count, .pixels = pixel_data };
+        stats_phase(workspace->stats, "read_pixels");
+        bool success = parallel_for(jobs, character_files_count, join_read_pixels, &all) &&
+                       write_deduplicated_font_tag(output_path, characters, character_files_count, pixel_data, character_tables, workspace->stats);
+        free(pixel_data);
+
+        return success;
+    }
+
+    // Everything but the pixel data can be written now, then pixels are streamed in after it.
+    // Pixels are read while the previous window is written, so the time for both goes to this phase.
+    stats_phase(workspace->stats, "write");
+    struct tag_writer writer;
+    bool success = start_font_tag(&writer, output_path, characters, character_files_count, pixels_offsets[character_files_count], character_tables, workspace->stats);
+    if(success) {
+        if(join_write_pixels(&writer, &join, character_files_count, jobs, workspace)) {
+            success = tag_writer_close(&writer);
+        }
+        else {
+            tag_writer_abort(&writer);
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+// Grow a buffer so size more bytes fit after the used part of it
+static bool reserve_buffer(uint8_t **buffer, size_t *capacity, size_t used, size_t size) {
+    if(*capacity - used >= size) {
+        return true;
+    }
+
+    size_t new_capacity = *capacity ? *capacity : 64 * 1024;
+    while(new_capacity - used < size) {
+        new_capacity *= 2;
+    }
+
+    uint8_t *new_buffer = realloc(*buffer, new_capacity);
+    if(!new_buffer) {
+        fprintf(stderr, "Could not allocate %zu bytes for pixel data\n", new_capacity);
+        return false;
+    }
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+
+    return true;
+}
+
+// Read character files from an archive on stdin. Each one goes in its character's place as it arrives, so they end up in
+// order however the archive was made. Pixels are kept in the order they arrived until the tag is written.
+static bool join_character_stream(const char *output_path, const struct join_options *options, uint8_t *character_tables, struct workspace *workspace) {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    // Character files are small, so read them in big pieces
+    setvbuf(stdin, nullptr, _IOFBF, 1 * 1024 * 1024);
+
+    stats_phase(workspace->stats, "read");
+    FILE *messages = join_messages(output_path);
+    struct font_character *characters = workspace->characters;
+    bool *seen = workspace->seen;
+    memset(seen, 0, (UINT16_MAX + 1) * sizeof(bool));
+    uint32_t characters_count = 0;
+    size_t pixel_data_size = 0;
+    size_t pixel_data_capacity = JOIN_WINDOW_SIZE;
+    uint8_t *pixel_data = malloc(pixel_data_capacity);
+    uint8_t *compressed_data = nullptr;
+    size_t compressed_data_capacity = 0;
+    bool success = false;
+    if(!pixel_data) {
+        fprintf(stderr, "Could not allocate %zu bytes for pixel data\n", pixel_data_capacity);
+        return false;
+    }
+
+    while(true) {
+        struct character_tar_entry entry;
+        bool end;
+        if(!character_tar_next(stdin, &entry, &end)) {
+            goto cleanup;
+        }
+        if(end) {
+            break;
+        }
+
+        if(seen[entry.character]) {
+            fprintf(stderr, "%s is not the only file for character %u\n", entry.name, entry.character);
+            goto cleanup;
+        }
+
+        // A tag counts its characters in 16 bits, so one file for every character is one too many
+        if(characters_count == UINT16_MAX) {
+            fprintf(stderr, "stdin has too many character files to be a valid font tag (must be at most %u)\n", UINT16_MAX);
+            goto cleanup;
+        }
+
+        // The size in the archive could be anything, so read the character struct first to check it. A compressed file
+        // keeps it in its header.
+        struct font_character *current_character = &characters[entry.character];
+        size_t pixels_size;
+        if(entry.compressed) {
+            struct character_rle_header header;
+            if(entry.size < sizeof(header)) {
+                fprintf(stderr, "%s is not a valid compressed character file\n", entry.name);
+                goto cleanup;
+            }
+            if(!character_tar_read(stdin, &entry, &header, sizeof(header))) {
+                goto cleanup;
+            }
+            if(!character_rle_header_valid(&header)) {
+                fprintf(stderr, "%s is not a valid compressed character file\n", entry.name);
+                goto cleanup;
+            }
+            *current_character = header.character;
+
+            size_t file_size = byteswap32(header.size);
+            if(file_size < sizeof(struct font_character)) {
+                fprintf(stderr, "%s is too small to be a font character\n", entry.name);
+                goto cleanup;
+            }
+            pixels_size = file_size - sizeof(struct font_character);
+        }
+        else {
+            if(entry.size < sizeof(struct font_character)) {
+                fprintf(stderr, "%s is too small to be a font character\n", entry.name);
+                goto cleanup;
+            }
+            if(!character_tar_read(stdin, &entry, current_character, sizeof(*current_character))) {
+                goto cleanup;
+            }
+            pixels_size = entry.size - sizeof(struct font_character);
+        }
+
+        // Checked before anything is allocated for the pixels
+        if(pixels_size != calculate_pixels_size(byteswap16(current_character->bitmap_width), byteswap16(current_character->bitmap_height))) {
+            fprintf(stderr, "pixel data size for %s is invalid\n", entry.name);
+            goto cleanup;
+        }
+
+        if(!reserve_buffer(&pixel_data, &pixel_data_capacity, pixel_data_size, pixels_size)) {
+            goto cleanup;
+        }
+
+        // Pixels are decompressed straight into the pixel data. Data that decodes to exactly pixels_size bytes can't be
+        // longer than the most that can take, so nothing more than that is allocated for it either.
+        if(entry.compressed) {
+            size_t data_size = entry.size - entry.read;
+            if(data_size > character_rle_max_size(pixels_size)) {
+                fprintf(stderr, "Could not read pixels from %s\n", entry.name);
+                goto cleanup;
+            }
+            if(!reserve_buffer(&compressed_data, &compressed_data_capacity, 0, data_size) || !character_tar_read(stdin, &entry, compressed_data, data_size)) {
+                goto cleanup;
+            }
+            if(!character_rle_decode(compressed_data, data_size, pixel_data + pixel_data_size, pixels_size)) {
+                fprintf(stderr, "Could not read pixels from %s\n", entry.name);
+                goto cleanup;
+            }
+        }
+        else if(!character_tar_read(stdin, &entry, pixel_data + pixel_data_size, pixels_size)) {
+            goto cleanup;
+        }
+        stats_count(workspace->stats, STATS_BYTES_READ, entry.size);
+
+        // Make sure the character we just loaded is set correctly
+        uint16_t old_char = byteswap16(current_character->character);
+        if(entry.character != old_char) {
+            fprintf(messages, "%s: importing internal character %u as %u\n", entry.name, old_char, entry.character);
+            current_character->character = byteswap16(entry.character);
+        }
+
+        if(pixels_size == 0) {
+            fprintf(stderr, "Warning: character %u has no pixel data\n", entry.character);
+            stats_count(workspace->stats, STATS_EMPTY_GLYPHS, 1);
+        }
+
+        // Where its pixels arrived for now
+        current_character->pixels_offset = byteswap32(pixel_data_size);
+        pixel_data_size += pixels_size;
+        seen[entry.character] = true;
+        characters_count++;
+    }
+
+    if(characters_count == 0) {
+        fprintf(stderr, "No valid font characters were found in stdin\n");
+        goto cleanup;
+    }
+
+    // Close the gaps. Every character moves down, so none is overwritten before it is moved.
+    stats_phase(workspace->stats, "layout");
+    uint32_t next = 0;
+    for(uint32_t character = 0; character <= UINT16_MAX; character++) {
+        if(seen[character]) {
+            characters[next++] = characters[character];
+        }
+    }
+
+    if(options->dedup) {
+        success = write_deduplicated_font_tag(output_path, characters, characters_count, pixel_data, character_tables, workspace->stats);
+        goto cleanup;
+    }
+
+    // Pixel data is stored in character order, which may not be the order it arrived in
+    size_t *sources = workspace->pixels_offsets;
+    size_t pixels_offset = 0;
+    for(uint32_t i = 0; i < characters_count; i++) {
+        sources[i] = byteswap32(characters[i].pixels_offset);
+        characters[i].pixels_offset = byteswap32(pixels_offset);
+        pixels_offset += calculate_pixels_size(byteswap16(characters[i].bitmap_width), byteswap16(characters[i].bitmap_height));
+    }
+
+    stats_phase(workspace->stats, "write");
+    struct tag_writer writer;
+    if(!start_font_tag(&writer, output_path, characters, characters_count, pixel_data_size, character_tables, workspace->stats)) {
+        goto cleanup;
+    }
+
+    for(uint32_t i = 0; i < characters_count; i++) {
+        size_t pixels_size = calculate_pixels_size(byteswap16(characters[i].bitmap_width), byteswap16(characters[i].bitmap_height));
+        tag_writer_write(&writer, pixel_data + sources[i], pixels_size);
+    }
+    success = tag_writer_close(&writer);
+
+    cleanup:
+    free(pixel_data);
+    free(compressed_data);
+
+    return success;
+}
+
+bool produce_font_tag_from_bullshit(const char *input, const char *output_path, const struct join_options *options, struct workspace *workspace) {
+    uint8_t *character_tables = options->no_tables ? nullptr : workspace->character_tables;
+    if(options->incremental && (options->dedup || options->bundle)) {
+        fprintf(stderr, "--incremental can only be used on its own\n");
+        return false;
+    }
+
+    if(options->incremental && strcmp(output_path, "-") == 0) {
+        fprintf(stderr, "--incremental can't write to stdout\n");
+        return false;
+    }
+
+    if(strcmp(input, "-") == 0) {
+        if(options->bundle || options->incremental) {
+            fprintf(stderr, "--%s can't read from stdin\n", options->bundle ? "bundle" : "incremental");
+            return false;
+        }
+
+        return join_character_stream(output_path, options, character_tables, workspace);
+    }
+
+    if(options->bundle) {
+        stats_phase(workspace->stats, "map");
+        struct glyph_bundle bundle;
+        if(!glyph_bundle_open(&bundle, input)) {
+            return false;
+        }
+
+        stats_count(workspace->stats, STATS_FILES_OPENED, 1);
+        stats_count(workspace->stats, STATS_BYTES_READ, bundle.file.size);
+
+        // Already sorted and validated, so it can go straight into the tag
+        struct tag_writer writer;
+        bool success;
+        if(options->dedup) {
+            memcpy(workspace->characters, bundle.characters, bundle.character_count * sizeof(struct font_character));
+            success = write_deduplicated_font_tag(output_path, workspace->characters, bundle.character_count, bundle.pixels, character_tables, workspace->stats);
+        }
+        else {
+            stats_phase(workspace->stats, "write");
+            success = start_font_tag(&writer, output_path, bundle.characters, bundle.character_count, bundle.pixels_size, character_tables, workspace->stats);
+            if(success) {
+                tag_writer_write(&writer, bundle.pixels, bundle.pixels_size);
+                success = tag_writer_close(&writer);
+            }
+        }
+
+        glyph_bundle_close(&bundle);
+
+        return success;
+    }
+
+    stats_phase(workspace->stats, "scan");
+    struct character_dir dir;
+    if(!character_dir_open(&dir, input)) {
+        return false;
+    }
+
+    bool success = join_character_dir(&dir, output_path, options, character_tables, workspace);
+    character_dir_close(&dir);
+
+    return success;
+}
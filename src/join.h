@@ -0,0 +1,16 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include "workspace.h"
+
+struct join_options {
+    bool bundle; // read a glyph bundle instead of a directory of character files
+    bool incremental; // only read character files that changed since the last join, using <output>.index. Not with bundle or dedup
+    bool dedup; // store identical bitmaps once
+    bool no_tables; // leave out the character lookup tables, like invader-font does
+    unsigned jobs; // number of threads reading character files
+};
+
+// Make a font tag from a directory of <character>.bin files, or a glyph bundle
+bool produce_font_tag_from_bullshit(const char *input, const char *output_path, const struct join_options *options, struct workspace *workspace);
@@ -0,0 +1,129 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "join_index.h"
+
+static void swap_header(struct join_index_header *header) {
+    header->signature = byteswap32(header->signature);
+    header->version = byteswap16(header->version);
+    header->entries_count = byteswap32(header->entries_count);
+    header->tag_checksum = byteswap32(header->tag_checksum);
+    header->tag_size = byteswap64(header->tag_size);
+    header->scan_time = (int64_t)byteswap64((uint64_t)header->scan_time);
+}
+
+static void swap_entry(struct join_index_entry *entry) {
+    entry->file_size = byteswap32(entry->file_size);
+    entry->file_mtime = (int64_t)byteswap64((uint64_t)entry->file_mtime);
+    entry->file_hash = byteswap64(entry->file_hash);
+}
+
+bool join_index_load(struct join_index *index, const char *path) {
+    *index = (struct join_index){0};
+
+    FILE *file_in = fopen(path, "rb");
+    if(!file_in) {
+        return false;
+    }
+
+    bool success = fread(&index->header, sizeof(index->header), 1, file_in) == 1;
+    swap_header(&index->header);
+    success = success && index->header.signature == JOIN_INDEX_SIGNATURE && index->header.version == JOIN_INDEX_VERSION;
+    success = success && index->header.entries_count > 0 && index->header.entries_count <= UINT16_MAX + 1;
+    if(success) {
+        index->entries = malloc(index->header.entries_count * sizeof(struct join_index_entry));
+        success = index->entries && fread(index->entries, sizeof(struct join_index_entry), index->header.entries_count, file_in) == index->header.entries_count;
+    }
+
+    fclose(file_in);
+
+    for(uint32_t i = 0; success && i < index->header.entries_count; i++) {
+        swap_entry(&index->entries[i]);
+        if(i > 0 && byteswap16(index->entries[i].character.character) <= byteswap16(index->entries[i - 1].character.character)) {
+            success = false;
+        }
+    }
+
+    if(!success) {
+        fprintf(stderr, "Warning: ignoring invalid join index %s\n", path);
+        join_index_free(index);
+    }
+
+    return success;
+}
+
+void join_index_free(struct join_index *index) {
+    free(index->entries);
+    *index = (struct join_index){0};
+}
+
+bool join_index_save(const struct join_index *index, const char *path) {
+    FILE *file_out = fopen(path, "wb");
+    if(!file_out) {
+        fprintf(stderr, "Could not open %s for writing\n", path);
+        return false;
+    }
+
+    setvbuf(file_out, nullptr, _IOFBF, 256 * 1024);
+
+    struct join_index_header header = index->header;
+    swap_header(&header);
+    bool success = fwrite(&header, sizeof(header), 1, file_out) == 1;
+    for(uint32_t i = 0; success && i < index->header.entries_count; i++) {
+        struct join_index_entry entry = index->entries[i];
+        swap_entry(&entry);
+        success = fwrite(&entry, sizeof(entry), 1, file_out) == 1;
+    }
+
+    if(fclose(file_out) != 0) {
+        success = false;
+    }
+
+    if(!success) {
+        fprintf(stderr, "Could not write join index %s\n", path);
+        remove(path);
+    }
+
+    return success;
+}
+
+const struct join_index_entry *join_index_find(const struct join_index *index, uint16_t character) {
+    size_t low = 0;
+    size_t high = index->header.entries_count;
+    while(low < high) {
+        size_t middle = low + (high - low) / 2;
+        uint16_t middle_character = byteswap16(index->entries[middle].character.character);
+        if(middle_character == character) {
+            return &index->entries[middle];
+        }
+        else if(middle_character < character) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return nullptr;
+}
+
+int64_t join_index_mtime(const struct stat *st) {
+#if defined(__APPLE__)
+    return (int64_t)st->st_mtimespec.tv_sec * 1000000000 + st->st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    return (int64_t)st->st_mtime * 1000000000;
+#else
+    return (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+#endif
+}
+
+int64_t join_index_now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
@@ -0,0 +1,51 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+#include "font.h"
+
+// Saved next to a joined tag (as <tag>.index) so the next join only has to read character files that changed.
+// Stored big endian. Entries are sorted by character.
+enum {
+    JOIN_INDEX_SIGNATURE = 0x66736978, // 'fsix'
+    JOIN_INDEX_VERSION = 1
+};
+
+struct join_index_header {
+    uint32_t signature;
+    uint16_t version;
+    char pad[2];
+    uint32_t entries_count;
+    uint32_t tag_checksum; // checksum of the tag this describes
+    uint64_t tag_size;
+    int64_t scan_time; // files modified at or after this may have changed without their mtime changing
+};
+static_assert(sizeof(struct join_index_header) == 32);
+
+struct join_index_entry {
+    struct font_character character; // as stored in the tag, pixels_offset included
+    uint32_t file_size;
+    int64_t file_mtime; // nanoseconds
+    uint64_t file_hash;
+};
+static_assert(sizeof(struct join_index_entry) == 40);
+
+// Loaded into host order, except for the font_character which stays as it is in the tag
+struct join_index {
+    struct join_index_header header;
+    struct join_index_entry *entries;
+};
+
+// Returns false without printing anything if there is no usable index
+bool join_index_load(struct join_index *index, const char *path);
+void join_index_free(struct join_index *index);
+bool join_index_save(const struct join_index *index, const char *path);
+const struct join_index_entry *join_index_find(const struct join_index *index, uint16_t character);
+
+// Modification time in nanoseconds, as precise as the platform gives it
+int64_t join_index_mtime(const struct stat *st);
+int64_t join_index_now(void);
@@ -4,638 +4,585 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
-#include <dirent.h>
-#include <sys/stat.h>
-
-#ifdef _WIN32
-    #include <direct.h>
-    #define MKDIR(path, mode) _mkdir(path)
-#else
+#include <threads.h>
+
+#include "diff.h"
+#include "join.h"
+#include "merge.h"
+#include "parallel.h"
+#include "repack.h"
+#include "split.h"
+#include "stats.h"
+#include "verify.h"
+#include "workspace.h"
+
+#ifndef _WIN32
     #include <libgen.h>
-    #define MKDIR(path, mode) mkdir(path, mode)
 #endif
 
-enum signatures {
-    TAG_HEADER_SIGNATURE = 0x626C616D, // 'blam'
-    FONT_SIGNATURE = 0x666F6E74, // 'font'
-    NULL_SIGNATURE = 0xFFFFFFFF
-};
+static void executable_basename(const char *path, char *name_buffer, size_t name_buffer_size) {
+#ifdef _WIN32
+    char exe_base[256];
+    char exe_ext[256];
+    auto split = _splitpath_s(path, nullptr, 0, nullptr, 0, exe_base, sizeof(exe_base), exe_ext, sizeof(exe_ext));
+    if(split) {
+        snprintf(name_buffer, name_buffer_size, "font-slicer");
+        return;
+    }
 
-struct tag_header {
-	char pad1[36];
-	uint32_t tag_group;
-	uint32_t checksum;
-	uint32_t offset; // offset to tag data, always 64
-	uint32_t size; // never set 😭
-	char pad2[4];
-	uint16_t version; // version of the tag
-	char pad3;
-	uint8_t unused_index; // always 255
-	uint32_t signature; // always 'blam'
-};
-static_assert(sizeof(struct tag_header) == 64);
+    strncpy(name_buffer, exe_base, name_buffer_size);
+    strncat(name_buffer, exe_ext, name_buffer_size - strnlen(name_buffer, name_buffer_size));
+#else
+    char *executable_path = strdup(path);
+    if(!executable_path) {
+        snprintf(name_buffer, name_buffer_size, "font-slicer");
+        return;
+    }
 
-struct tag_reflexive {
-	uint32_t count;
-	uint32_t address; // 32-bit pointer to array
-	uint32_t definition; // 32-bit pointer to tag definition (in-engine only)
-};
-static_assert(sizeof(struct tag_reflexive) == 12);
-
-struct tag_data {
-	uint32_t size;
-	char pad[4];
-	uint32_t file_offset; // not in loose tags
-	uint32_t address; // 32-bit pointer to data
-	uint32_t definition;// 32-bit pointer to data definition (in-engine only)
-};
-static_assert(sizeof(struct tag_data) == 20);
+    char *name = basename(executable_path);
+    strncpy(name_buffer, name, name_buffer_size);
 
-struct tag_reference {
-	uint32_t tag_group;
-	uint32_t name; // 32-bit pointer to name
-	uint32_t name_length;
-	uint32_t index; //tag index (two-part tag id)
-};
-static_assert(sizeof(struct tag_reference) == 16);
+    free(executable_path);
+#endif
+}
 
-struct font_character_table_entry {
-	uint16_t character_index;
+enum command_type {
+    COMMAND_SPLIT,
+    COMMAND_JOIN,
+    COMMAND_REPACK,
+    COMMAND_MERGE,
+    COMMAND_VERIFY,
+    COMMAND_DIFF,
+    COMMAND_BATCH
 };
-static_assert(sizeof(struct font_character_table_entry) == 2);
 
-struct font_character_tables_entry {
-	struct tag_reflexive table;
-};
-static_assert(sizeof(struct font_character_tables_entry) == 12);
-
-struct font_character {
-	uint16_t character;
-	int16_t character_width;
-	int16_t bitmap_width;
-	int16_t bitmap_height;
-	int16_t bitmap_origin_x;
-	int16_t bitmap_origin_y;
-	uint16_t hardware_character_index;
-	char pad[2];
-	uint32_t pixels_offset; // offset into pixels buffer
-};
-static_assert(sizeof(struct font_character) == 20);
-
-#define STYLE_FONTS_COUNT 4
-struct font_base {
-	uint32_t flags;
-	int16_t ascending_height;
-	int16_t descending_height;
-	int16_t leading_height;
-	int16_t leading_width;
-	char pad[36];
-	struct tag_reflexive character_tables; // we don't care about these.
-	struct tag_reference style_fonts[STYLE_FONTS_COUNT];
-	struct tag_reflexive characters;
-	struct tag_data pixels;
-};
-static_assert(sizeof(struct font_base) == 156);
-
-/*
- *  CRC code COPYRIGHT (C) 1986 Gary S. Brown.  You may use this program, or
- *  code or tables extracted from it, as desired without restriction.
- */
-
-static uint32_t crc32_tab[] = {
-    0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
-    0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
-    0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2,
-    0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
-    0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9,
-    0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172,
-    0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b, 0x35b5a8fa, 0x42b2986c,
-    0xdbbbc9d6, 0xacbcf940, 0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
-    0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423,
-    0xcfba9599, 0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
-    0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d, 0x76dc4190, 0x01db7106,
-    0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
-    0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d,
-    0x91646c97, 0xe6635c01, 0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e,
-    0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
-    0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
-    0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2, 0x4adfa541, 0x3dd895d7,
-    0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0,
-    0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa,
-    0xbe0b1010, 0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
-    0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81,
-    0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a,
-    0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683, 0xe3630b12, 0x94643b84,
-    0x0d6d6a3e, 0x7a6a5aa8, 0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
-    0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb,
-    0x196c3671, 0x6e6b06e7, 0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc,
-    0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5, 0xd6d6a3e8, 0xa1d1937e,
-    0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
-    0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55,
-    0x316e8eef, 0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
-    0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe, 0xb2bd0b28,
-    0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
-    0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f,
-    0x72076785, 0x05005713, 0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38,
-    0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242,
-    0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
-    0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c, 0x8f659eff, 0xf862ae69,
-    0x616bffd3, 0x166ccf45, 0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2,
-    0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc,
-    0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
-    0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693,
-    0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
-    0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
+static const char *command_names[] = { "split", "join", "repack", "merge", "verify", "diff", "batch" };
+
+#define COMMAND_MAX_DONORS 16
+
+struct command {
+    enum command_type type;
+    const char *input;
+    const char *output;
+    const char *donors[COMMAND_MAX_DONORS + 1]; // for merge. The output is taken off the end once every argument is read
+    uint32_t donors_count;
+    const char **paths; // for verify. Every path, moved to the front of argv
+    uint32_t paths_count;
+    const char *ranges;
+    const char *codepoints;
+    bool bundle;
+    bool compress;
+    bool incremental;
+    bool dedup;
+    bool no_tables;
+    enum stats_format stats_format;
+    unsigned jobs;
 };
 
-static uint32_t crc32(uint32_t crc, const void *buf, size_t size) {
-    const uint8_t *p;
-    p = buf;
-    while(size--) {
-        crc = crc32_tab[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+// Parse a command and its arguments. argv[0] is the command name.
+static bool parse_command(int argc, const char **argv, struct command *command) {
+    *command = (struct command){ .jobs = 1 };
+    if(argc < 1) {
+        return false;
     }
 
-    return crc;
-}
-
-static uint16_t byteswap16(uint16_t value) {
-    return (value << 8) | (value >> 8);
-}
-
-static uint32_t byteswap32(uint32_t value) {
-    return ((value & 0xFF) << 24) | ((value & 0xFF00) << 8) | ((value & 0xFF0000) >> 8) | (value >> 24);
-}
-
-static size_t calculate_pixels_size(int16_t width, int16_t height) {
-    size_t pixels_size = 0;
-    // Ask bungie
-    if(width > 0 && height > 0) {
-        pixels_size = width * height;
+    const char *name = argv[0];
+    if(strcmp(name, "split") == 0) {
+        command->type = COMMAND_SPLIT;
     }
-
-    return pixels_size;
-}
-
-static int compare_characters(const void *a, const void *b) {
-    uint16_t value_a = *(const uint16_t *)a;
-    uint16_t value_b = *(const uint16_t *)b;
-
-    if(value_a < value_b) {
-        return -1;
+    else if(strcmp(name, "join") == 0) {
+        command->type = COMMAND_JOIN;
     }
-    else if (value_a > value_b) {
-        return 1;
+    else if(strcmp(name, "repack") == 0) {
+        command->type = COMMAND_REPACK;
+    }
+    else if(strcmp(name, "merge") == 0) {
+        command->type = COMMAND_MERGE;
+    }
+    else if(strcmp(name, "verify") == 0) {
+        command->type = COMMAND_VERIFY;
+    }
+    else if(strcmp(name, "diff") == 0) {
+        command->type = COMMAND_DIFF;
+    }
+    else if(strcmp(name, "batch") == 0) {
+        command->type = COMMAND_BATCH;
+    }
+    else {
+        fprintf(stderr, "Unknown command %s\n", name);
+        return false;
     }
 
-    return 0;
-}
+    // Options can go anywhere after the command
+    for(int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if(strcmp(arg, "--bundle") == 0 && (command->type == COMMAND_SPLIT || command->type == COMMAND_JOIN)) {
+            command->bundle = true;
+        }
+        else if(strcmp(arg, "--compress") == 0 && command->type == COMMAND_SPLIT) {
+            command->compress = true;
+        }
+        else if(strcmp(arg, "--incremental") == 0 && command->type == COMMAND_JOIN) {
+            command->incremental = true;
+        }
+        else if(strcmp(arg, "--dedup") == 0 && (command->type == COMMAND_JOIN || command->type == COMMAND_MERGE)) {
+            command->dedup = true;
+        }
+        else if(strcmp(arg, "--no-tables") == 0 && (command->type == COMMAND_JOIN || command->type == COMMAND_REPACK || command->type == COMMAND_MERGE)) {
+            command->no_tables = true;
+        }
+        else if((strcmp(arg, "--stats") == 0 || strcmp(arg, "--stats=json") == 0) && (command->type == COMMAND_SPLIT || command->type == COMMAND_JOIN || command->type == COMMAND_MERGE || command->type == COMMAND_DIFF)) {
+            command->stats_format = arg[7] == '=' ? STATS_JSON : STATS_TEXT;
+        }
+        else if((strcmp(arg, "--ranges") == 0 || strcmp(arg, "--codepoints") == 0) && (command->type == COMMAND_SPLIT || command->type == COMMAND_MERGE)) {
+            bool allow_ranges = arg[2] == 'r';
+            if(++i == argc) {
+                fprintf(stderr, "%s needs a list of characters\n", arg);
+                return false;
+            }
 
-static bool split_font_tag(const char *tag_path, const char *output_dir) {
-    FILE *file_in = nullptr;
-    uint8_t *buffer_in = nullptr;
-    size_t buffer_in_size = 0;
+            if(!character_ranges_parse(arg, argv[i], allow_ranges, nullptr)) {
+                return false;
+            }
 
-    // Open font tag
-    file_in = fopen(tag_path, "rb");
-    if(!file_in) {
-        fprintf(stderr, "Failed to open %s\n", tag_path);
-        return false;
+            *(allow_ranges ? &command->ranges : &command->codepoints) = argv[i];
+        }
+        else if(strcmp(arg, "--jobs") == 0) {
+            char *end;
+            if(++i == argc || (command->jobs = strtoul(argv[i], &end, 10)) < 1 || command->jobs > PARALLEL_MAX_JOBS || *end != '\0') {
+                fprintf(stderr, "--jobs needs a number from 1 to %d\n", PARALLEL_MAX_JOBS);
+                return false;
+            }
+        }
+        else if(strncmp(arg, "--", 2) == 0) {
+            fprintf(stderr, "Unknown option %s\n", arg);
+            return false;
+        }
+        else if(command->type == COMMAND_VERIFY) {
+            // Everything before this argument has been read already, so it can be overwritten
+            argv[command->paths_count++] = arg;
+            command->paths = argv;
+            command->input = argv[0];
+        }
+        else if(!command->input) {
+            command->input = arg;
+        }
+        else if(command->type == COMMAND_MERGE) {
+            if(command->donors_count == COMMAND_MAX_DONORS + 1) {
+                fprintf(stderr, "merge can take at most %d donor tags\n", COMMAND_MAX_DONORS);
+                return false;
+            }
+            command->donors[command->donors_count++] = arg;
+        }
+        else if(!command->output && command->type != COMMAND_BATCH) {
+            command->output = arg;
+        }
+        else {
+            fprintf(stderr, "Too many arguments for %s\n", name);
+            return false;
+        }
     }
 
-    // Get size and check if big enough
-    fseek(file_in, 0, SEEK_END);
-    buffer_in_size = ftell(file_in);
-    fseek(file_in, 0, SEEK_SET);
-    if(buffer_in_size < sizeof(struct tag_header) + sizeof(struct font_base)) {
-        fprintf(stderr, "%s is too small to be a valid font tag\n", tag_path);
-        return false;
+    // A merge needs at least one donor before its output
+    if(command->type == COMMAND_MERGE && command->donors_count >= 2) {
+        command->output = command->donors[--command->donors_count];
     }
 
-    // Read into buffer
-    buffer_in = malloc(buffer_in_size);
-    if(!buffer_in) {
-        fprintf(stderr, "Could not allocate %zu bytes for input buffer", buffer_in_size);
+    if(command->incremental && (command->dedup || command->bundle)) {
+        fprintf(stderr, "--incremental can only be used on its own\n");
         return false;
     }
 
-    if(fread(buffer_in, buffer_in_size, 1, file_in) != 1) {
-        fprintf(stderr, "Could not read from %s\n", tag_path);
+    if(!command->input || (!command->output && command->type != COMMAND_BATCH && command->type != COMMAND_VERIFY)) {
+        fprintf(stderr, "Not enough arguments for %s\n", name);
         return false;
     }
 
-    fclose(file_in);
-    file_in = nullptr;
-
-    // Check if it's really a font tag
-    struct tag_header *header = (struct tag_header *)buffer_in;
-    if(byteswap32(header->signature) != TAG_HEADER_SIGNATURE || byteswap32(header->tag_group) != FONT_SIGNATURE) {
-        fprintf(stderr, "%s is not a valid font tag\n", tag_path);
+    // - is stdin for join and stdout for split and join. batch takes it as its manifest on its own.
+    if(command->type != COMMAND_JOIN && command->type != COMMAND_BATCH && strcmp(command->input, "-") == 0) {
+        fprintf(stderr, "%s can't read from stdin\n", name);
         return false;
     }
 
-    struct font_base *font = (struct font_base *)(buffer_in + sizeof(struct tag_header));
-
-    // do we even have characters?
-    uint32_t characters_count = byteswap32(font->characters.count);
-    if(characters_count == 0) {
-        fprintf(stderr, "%s has no characters to split\n", tag_path);
+    if(command->type != COMMAND_SPLIT && command->type != COMMAND_JOIN && command->output && strcmp(command->output, "-") == 0) {
+        fprintf(stderr, "%s can't write to stdout\n", name);
         return false;
     }
 
-    // do we have too many characters?
-    if(characters_count > UINT16_MAX) {
-        fprintf(stderr, "%s has too many characters to be a valid font tag\n", tag_path);
-        return false;
+    return true;
+}
+
+// Characters picked with --ranges and --codepoints, or null if there are none. Both were checked when the command was parsed.
+static const struct character_ranges *command_ranges(const struct command *command, struct character_ranges *ranges) {
+    if(!command->ranges && !command->codepoints) {
+        return nullptr;
     }
 
-    // do we have pixel data?
-    size_t pixel_data_size = byteswap32(font->pixels.size);
-    if(pixel_data_size == 0) {
-        fprintf(stderr, "%s has no pixel data\n", tag_path);
-        return false;
+    *ranges = (struct character_ranges){0};
+    if(command->ranges) {
+        character_ranges_parse("--ranges", command->ranges, true, ranges);
+    }
+    if(command->codepoints) {
+        character_ranges_parse("--codepoints", command->codepoints, false, ranges);
     }
 
-    // Start going through the rest of the tag data
-    size_t font_tag_cursor = sizeof(struct tag_header) + sizeof(struct font_base);
+    return ranges;
+}
 
-    // Add size of character tables if they exist
-    uint32_t character_tables_count = byteswap32(font->character_tables.count);
-    if(character_tables_count != 0) {
-        size_t character_tables_size = character_tables_count * sizeof(struct font_character_tables_entry);
-        if(buffer_in_size < font_tag_cursor + character_tables_size) {
-            fprintf(stderr, "%s has character tables that are out of bounds\n", tag_path);
-            return false;
-        }
+static bool run_command(const struct command *command, struct workspace *workspace) {
+    if(command->stats_format != STATS_NONE) {
+        workspace->stats = &workspace->command_stats;
+        stats_start(workspace->stats, command->stats_format, command_names[command->type]);
 
-        struct font_character_tables_entry *character_tables = (struct font_character_tables_entry *)(buffer_in + font_tag_cursor);
-        for(uint32_t i = 0; i < character_tables_count; i++) {
-            font_tag_cursor += byteswap32(character_tables->table.count) * sizeof(struct font_character_table_entry);
-            character_tables++;
+        // Keep stdout for the command's output if it is being written there
+        if(strcmp(command->output, "-") == 0) {
+            workspace->stats->output = stderr;
         }
-        font_tag_cursor += character_tables_size;
     }
 
-    // Add up any paths from the references
-    for(int i = 0; i < STYLE_FONTS_COUNT; i++) {
-        uint32_t name_legnth = byteswap32(font->style_fonts[i].name_length);
-        if(name_legnth != 0) {
-            font_tag_cursor += name_legnth + 1;
-        }
-    }
+    struct character_ranges ranges;
+    bool success;
+    switch(command->type) {
+        case COMMAND_SPLIT:
+            struct split_options split = { .bundle = command->bundle, .compress = command->compress, .jobs = command->jobs, .ranges = command_ranges(command, &ranges) };
+            success = split_font_tag(command->input, command->output, &split, workspace);
+            break;
+        case COMMAND_JOIN:
+            struct join_options join = { .bundle = command->bundle, .incremental = command->incremental, .dedup = command->dedup, .no_tables = command->no_tables, .jobs = command->jobs };
+            success = produce_font_tag_from_bullshit(command->input, command->output, &join, workspace);
+            break;
+        case COMMAND_REPACK:
+            struct repack_options repack = { .no_tables = command->no_tables };
+            success = repack_font_tag(command->input, command->output, &repack, workspace);
+            break;
+        case COMMAND_DIFF:
+            success = diff_font_tags(command->input, command->output, nullptr, workspace);
+            break;
+        case COMMAND_MERGE:
+            struct merge_options merge = { .ranges = command_ranges(command, &ranges), .dedup = command->dedup, .no_tables = command->no_tables };
+            success = merge_font_tags(command->input, command->donors, command->donors_count, command->output, &merge, workspace);
+            break;
+        default:
+            success = false;
+            break;
+    }
+
+    if(workspace->stats) {
+        stats_finish(workspace->stats, success);
+        workspace->stats = nullptr;
+    }
+
+    return success;
+}
 
-    // Offset to character data
-    size_t characters_offset = font_tag_cursor;
+#define BATCH_MAX_ARGS 16
+#define BATCH_NO_JOB UINT32_MAX
+
+struct batch_job {
+    char *line; // tokens point into this
+    size_t line_number;
+    struct command command;
+    uint32_t depends_on[COMMAND_MAX_DONORS + 1]; // earlier jobs that write this job's inputs
+    uint32_t depends_on_count;
+    uint32_t after; // the last earlier job that writes the same output, or BATCH_NO_JOB
+    bool done;
+    bool success;
+};
 
-    // Offset to pixel data
-    size_t pixel_data_offset = font_tag_cursor + characters_count * sizeof(struct font_character);
-    if(buffer_in_size != pixel_data_offset + pixel_data_size) {
-        fprintf(stderr, "%s is fucked\n", tag_path);
-        return false;
-    }
+struct batch {
+    struct batch_job *jobs;
+    uint32_t jobs_count;
+    uint32_t next_job;
+    uint32_t failed_jobs;
+    mtx_t lock;
+    cnd_t job_done;
+};
 
-    // Check output directory exists, make it if not (parent must exist)
-    struct stat st = {0};
-    if(stat(output_dir, &st) == -1) {
-        if(MKDIR(output_dir, 0777) == -1) {
-            fprintf(stderr, "Error creating directory %s\n", output_dir);
-            return false;
+// Split a manifest line into whitespace separated arguments, which can be "quoted". Modifies the line.
+static int tokenize_line(char *line, const char **args, int max_args) {
+    int count = 0;
+    char *p = line;
+    while(true) {
+        while(*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+            p++;
         }
-    }
-    else if(!S_ISDIR(st.st_mode)) {
-        fprintf(stderr, "Output %s is not a valid directory path\n", output_dir);
-        return false;
-    }
-
-    // Output buffer
-    size_t buffer_out_size = 1 * 1024 * 1024;
-    uint8_t *buffer_out = malloc(buffer_out_size);
-    if(!buffer_out) {
-        fprintf(stderr, "Could not allocate %zu bytes for output buffer", buffer_out_size);
-        return false;
-    }
 
-    // Go through each character and dump tag data + pixel data to a file
-    static char output_path[512];
-    static bool seen[UINT16_MAX] = {false};
-    struct font_character *character = (struct font_character *)(buffer_in + characters_offset);
-    for(uint32_t i = 0; i < characters_count; i++) {
-        uint16_t character_type = byteswap16(character->character);
-        if(seen[character_type]) {
-            fprintf(stderr, "Warning: skipped extracting duplicate character %u at index %u\n", character_type, i);
-            continue;
+        if(*p == '\0' || *p == '#') {
+            return count;
         }
 
-        seen[character_type] = true;
-        snprintf(output_path, sizeof(output_path), "%s/%u.bin", output_dir, character_type);
-        size_t pixels_size = calculate_pixels_size(byteswap16(character->bitmap_width), byteswap16(character->bitmap_height));
-        size_t pixels_offset = pixel_data_offset + byteswap32(character->pixels_offset);
-        if(pixels_size > pixel_data_size) {
-            fprintf(stderr, "Pixel data for character %u is out of bounds\n", i);
-            return false;
+        if(count == max_args) {
+            return -1;
         }
 
-        // Copy file data to save
-        size_t character_file_size = sizeof(struct font_character) + pixels_size;
-        if(character_file_size > buffer_out_size) {
-            fprintf(stderr, "Character %u is too large for output buffer\n", i);
-            return false;
+        char end = ' ';
+        if(*p == '"') {
+            end = '"';
+            p++;
         }
 
-        memset(buffer_out, 0, character_file_size);
-        struct font_character *character_out = (struct font_character *)buffer_out;
-        *character_out = *character;
-        if(pixels_size != 0) {
-            memcpy(buffer_out + sizeof(struct font_character), buffer_in + pixels_offset, pixels_size);
-        }
-        else {
-            fprintf(stderr, "Warning: character %u has no pixel data\n", i);
+        args[count++] = p;
+        while(*p != '\0' && !(end == '"' ? *p == '"' : (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))) {
+            p++;
         }
 
-        // Clear stale pixel data offset
-        character_out->pixels_offset = 0;
-
-        // Save file
-        FILE *file_out;
-        file_out = fopen(output_path, "wb");
-        if(!file_out) {
-            fprintf(stderr, "Could not open %s for writing\n", output_path);
-            return false;
+        if(end == '"' && *p != '"') {
+            return -1;
         }
 
-        if(fwrite(buffer_out, character_file_size, 1, file_out) != 1) {
-            fprintf(stderr, "Could not write %zu bytes to %s\n", character_file_size, output_path);
-            return false;
+        if(*p != '\0') {
+            *p++ = '\0';
         }
-
-        fclose(file_out);
-        character++;
     }
-
-    free(buffer_in);
-    free(buffer_out);
-
-    return true;
 }
 
-static bool produce_font_tag_from_bullshit(const char *input_dir, const char *output_path) {
-    DIR *d;
-    struct dirent *dir;
-    static uint16_t character_files[UINT16_MAX];
-    int character_files_count = 0;
-    d = opendir(input_dir);
-    if(d) {
-        while((dir = readdir(d)) != nullptr) {
-            // Exclude "." and ".."
-            if(strcmp(dir->d_name, ".") != 0 && strcmp(dir->d_name, "..") != 0) {
-                size_t name_len = strlen(dir->d_name);
-                if(name_len > 9) {
-                    fprintf(stderr, "%s has too long of a name to be a valid character file\n", dir->d_name);
-                    return false;
-                }
-
-                int file_value, position;
-                auto result = sscanf(dir->d_name, "%d.bin%n", &file_value, &position);
-                if(result != 1 || (size_t)position != name_len) {
-                    fprintf(stderr, "%s is not named with format <character number>.bin\n", dir->d_name);
-                    return false;
-                }
-
-                if(file_value > UINT16_MAX || file_value < 0) {
-                    fprintf(stderr, "%s is out of bounds to be a valid font character (must be 0-65535)\n", dir->d_name);
-                    return false;
-                }
-
-                character_files[character_files_count] = file_value;
-                character_files_count++;
-            }
-        }
-
-        closedir(d);
-    }
-    else {
-        fprintf(stderr, "Could not open directory %s\n", input_dir);
-        return false;
-    }
-
-    // Nothing to do if there are no characters
-    if(character_files_count == 0) {
-        fprintf(stderr, "No valid font characters were found in %s\n", input_dir);
-        return false;
+static void batch_free(struct batch *batch) {
+    for(uint32_t j = 0; j < batch->jobs_count; j++) {
+        free(batch->jobs[j].line);
     }
 
-    // Font characters should be stored from lowest to highest
-    qsort(character_files, character_files_count, sizeof(uint16_t), compare_characters);
-
-    size_t new_pixel_data_size = 0;
-    size_t pixel_data_buffer_size = 32 * 1024 * 1024;
-    uint8_t *pixel_data_buffer = calloc(pixel_data_buffer_size, 1);
-    struct font_character *characters_buffer = calloc(UINT16_MAX, sizeof(struct font_character));
+    free(batch->jobs);
+    batch->jobs = nullptr;
+    batch->jobs_count = 0;
+}
 
-    if(!pixel_data_buffer || !characters_buffer) {
-        fprintf(stderr, "Could not allocate pixel and character buffers\n");
+// Read every job from a manifest. Nothing runs unless the whole manifest is valid.
+static bool batch_read_manifest(struct batch *batch, const char *manifest_path) {
+    FILE *manifest = strcmp(manifest_path, "-") == 0 ? stdin : fopen(manifest_path, "r");
+    if(!manifest) {
+        fprintf(stderr, "Failed to open %s\n", manifest_path);
         return false;
     }
 
-    // Get all of our character and pixel data
-    struct font_character *current_character = characters_buffer;
-    static char path_buffer[512];
-    int16_t max_ascending_height = 1;
-    int16_t max_descending_height = 1;
-    for(int i = 0; i < character_files_count; i++) {
-        // Open
-        FILE *file_in = nullptr;
-        size_t file_in_size = 0;
-        snprintf(path_buffer, sizeof(path_buffer), "%s/%u.bin", input_dir, character_files[i]);
-        file_in = fopen(path_buffer, "rb");
-        if(!file_in) {
-            fprintf(stderr, "Failed to open %s\n", path_buffer);
-            return false;
+    uint32_t jobs_capacity = 0;
+    size_t line_number = 0;
+    char line[4096];
+    bool success = true;
+    while(success && fgets(line, sizeof(line), manifest)) {
+        line_number++;
+        if(strchr(line, '\n') == nullptr && !feof(manifest)) {
+            fprintf(stderr, "%s:%zu: line is too long\n", manifest_path, line_number);
+            success = false;
+            break;
         }
 
-        // Get size
-        fseek(file_in, 0, SEEK_END);
-        file_in_size = ftell(file_in);
-        fseek(file_in, 0, SEEK_SET);
-
-        if(file_in_size < sizeof(struct font_character)) {
-            fprintf(stderr, "%s is too small to be a font character\n", path_buffer);
-            return false;
+        struct batch_job job = { .line = strdup(line), .line_number = line_number, .after = BATCH_NO_JOB };
+        if(!job.line) {
+            fprintf(stderr, "Could not allocate manifest line\n");
+            success = false;
+            break;
         }
 
-        // Read character struct
-        if(fread(current_character, sizeof(struct font_character), 1, file_in) != 1) {
-            fprintf(stderr, "Could not read character data from %s\n", path_buffer);
-            return false;
+        const char *args[BATCH_MAX_ARGS];
+        int args_count = tokenize_line(job.line, args, BATCH_MAX_ARGS);
+        if(args_count == 0) {
+            free(job.line);
+            continue;
         }
 
-        // Check remaning file size matches what is expected
-        size_t pixels_size = calculate_pixels_size(byteswap16(current_character->bitmap_width), byteswap16(current_character->bitmap_height));
-        if(file_in_size != sizeof(struct font_character) + pixels_size) {
-            fprintf(stderr, "pixel data size for %s is invalid\n", path_buffer);
-            return false;
+        if(args_count < 0 || !parse_command(args_count, args, &job.command) || job.command.type == COMMAND_BATCH || job.command.type == COMMAND_VERIFY || job.command.type == COMMAND_DIFF) {
+            fprintf(stderr, "%s:%zu: not a valid split, join, repack or merge job\n", manifest_path, line_number);
+            free(job.line);
+            success = false;
+            break;
         }
 
-        // Will we explode?
-        if(new_pixel_data_size + pixels_size > pixel_data_buffer_size) {
-            fprintf(stderr, "Ran out of space for pixel data (>32MiB). Goodbye.\n");
-            return false;
+        // Jobs run at the same time, so they can't share stdin or stdout
+        if(strcmp(job.command.input, "-") == 0 || strcmp(job.command.output, "-") == 0) {
+            fprintf(stderr, "%s:%zu: - can't be used in a batch\n", manifest_path, line_number);
+            free(job.line);
+            success = false;
+            break;
         }
 
-        // Make sure the character we just loaded is set correctly
-        uint16_t old_char = byteswap16(current_character->character);
-        if(character_files[i] != old_char) {
-            printf("%s: importing internal character %u as %u\n", path_buffer, old_char, character_files[i]);
-            current_character->character = byteswap16(character_files[i]);
+        if(batch->jobs_count == jobs_capacity) {
+            jobs_capacity = jobs_capacity ? jobs_capacity * 2 : 64;
+            struct batch_job *jobs = realloc(batch->jobs, jobs_capacity * sizeof(struct batch_job));
+            if(!jobs) {
+                fprintf(stderr, "Could not allocate batch jobs\n");
+                free(job.line);
+                success = false;
+                break;
+            }
+            batch->jobs = jobs;
         }
 
-        // This is always set to the current position, even if there are no pixels
-        current_character->pixels_offset = byteswap32(new_pixel_data_size);
-
-        // Copy pixels if we have any.
-        if(pixels_size != 0) {
-            if(fread(pixel_data_buffer + new_pixel_data_size, pixels_size, 1, file_in) != 1) {
-                fprintf(stderr, "Could not read pixels from %s\n", path_buffer);
-                return false;
+        // A job that reads what an earlier job writes (like a join after a split) has to wait for it.
+        // Only the last job to write each input matters.
+        for(uint32_t d = 0; d <= job.command.donors_count; d++) {
+            const char *input = d == 0 ? job.command.input : job.command.donors[d - 1];
+            for(uint32_t j = batch->jobs_count; j-- > 0;) {
+                if(strcmp(batch->jobs[j].command.output, input) == 0) {
+                    job.depends_on[job.depends_on_count++] = j;
+                    break;
+                }
             }
-
-            new_pixel_data_size += pixels_size;
         }
-        else {
-            fprintf(stderr, "Warning: character %u has no pixel data\n", character_files[i]);
+
+        // Two jobs writing the same output (or the same <output>.tmp) at once would write over each other, so the later
+        // one waits. It still runs if the earlier one failed, since it doesn't use anything that one made.
+        for(uint32_t j = batch->jobs_count; j-- > 0;) {
+            if(strcmp(batch->jobs[j].command.output, job.command.output) == 0) {
+                job.after = j;
+                break;
+            }
         }
 
-        fclose(file_in);
+        batch->jobs[batch->jobs_count++] = job;
+    }
 
-        // Approximate. Will match invader-font, but tool.exe uses values directly from Windows
-        // These can be adjusted after the fact anyway
-        int16_t descending_height = byteswap16(current_character->bitmap_height) - byteswap16(current_character->bitmap_origin_y);
-        int16_t ascending_height = byteswap16(current_character->bitmap_height) - descending_height;
-        if(ascending_height > max_ascending_height) {
-            max_ascending_height = ascending_height;
-        }
+    if(manifest != stdin) {
+        fclose(manifest);
+    }
 
-        if(descending_height > max_descending_height) {
-            max_descending_height = descending_height;
-        }
+    if(!success) {
+        batch_free(batch);
+    }
+
+    return success;
+}
 
-        current_character++;
+static void batch_wait(struct batch *batch, const struct batch_job *job) {
+    mtx_lock(&batch->lock);
+    while(!job->done) {
+        cnd_wait(&batch->job_done, &batch->lock);
     }
+    mtx_unlock(&batch->lock);
+}
 
-    // Make a tag
-    size_t new_character_data_offset = sizeof(struct tag_header) + sizeof(struct font_base);
-    size_t new_character_data_size = sizeof(struct font_character) * character_files_count;
-    size_t new_pixel_data_offset = new_character_data_offset + new_character_data_size;
-    size_t new_tag_buffer_size = new_character_data_offset + new_character_data_size + new_pixel_data_size;
-    uint8_t *new_tag_buffer = calloc(new_tag_buffer_size, 1);
-    if(!new_tag_buffer) {
-        fprintf(stderr, "Could not allocate tag file buffer\n");
+// Each worker keeps its own workspace and takes the next job until there are none left
+static bool batch_worker_run(void *context, uint32_t, uint32_t) {
+    struct batch *batch = context;
+    struct workspace *workspace = workspace_new();
+    if(!workspace) {
         return false;
     }
 
-    // Setup header
-    struct tag_header *new_tag_header = (struct tag_header *)new_tag_buffer;
-    new_tag_header->tag_group = byteswap32(FONT_SIGNATURE);
-    new_tag_header->offset = byteswap32(sizeof(struct tag_header));
-    new_tag_header->unused_index = 255;
-    new_tag_header->version = byteswap16(1);
-    new_tag_header->signature = byteswap32(TAG_HEADER_SIGNATURE);
+    while(true) {
+        mtx_lock(&batch->lock);
+        uint32_t j = batch->next_job++;
+        mtx_unlock(&batch->lock);
+        if(j >= batch->jobs_count) {
+            break;
+        }
+
+        // Jobs are taken in order, so anything this waits for is already running
+        struct batch_job *job = &batch->jobs[j];
+        if(job->after != BATCH_NO_JOB) {
+            batch_wait(batch, &batch->jobs[job->after]);
+        }
 
-    // Setup font base struct
-    struct font_base *new_font_base = (struct font_base *)(new_tag_buffer + sizeof(struct tag_header));
+        bool dependencies_succeeded = true;
+        for(uint32_t d = 0; d < job->depends_on_count; d++) {
+            const struct batch_job *dependency = &batch->jobs[job->depends_on[d]];
+            batch_wait(batch, dependency);
+            if(!dependency->success && dependencies_succeeded) {
+                fprintf(stderr, "Skipping line %zu because line %zu failed\n", job->line_number, dependency->line_number);
+                dependencies_succeeded = false;
+            }
+        }
 
-    // Set these
-    new_font_base->ascending_height = byteswap16(max_ascending_height);
-    new_font_base->descending_height = byteswap16(max_descending_height);
-    new_font_base->pixels.size = byteswap32(new_pixel_data_size);
-    new_font_base->characters.count = byteswap32(character_files_count);
+        job->success = dependencies_succeeded && run_command(&job->command, workspace);
 
-    // I could leave this, but I want the file to round-trip as if it were just made by invader-font
-    for(int i = 0; i < STYLE_FONTS_COUNT; i++) {
-        new_font_base->style_fonts[i].tag_group = byteswap32(FONT_SIGNATURE);
-        new_font_base->style_fonts[i].index = 0xFFFFFFFF;
+        mtx_lock(&batch->lock);
+        job->done = true;
+        cnd_broadcast(&batch->job_done);
+        if(!job->success) {
+            batch->failed_jobs++;
+        }
+        printf("[%s] %zu: %s %s -> %s\n", job->success ? "ok" : "FAILED", job->line_number, command_names[job->command.type], job->command.input, job->command.output);
+        fflush(stdout);
+        mtx_unlock(&batch->lock);
     }
 
-    // Copy characters
-    memcpy(new_tag_buffer + new_character_data_offset, characters_buffer, new_character_data_size);
-    free(characters_buffer);
-
-    // Copy pixel data
-    memcpy(new_tag_buffer + new_pixel_data_offset, pixel_data_buffer, new_pixel_data_size);
-    free(pixel_data_buffer);
+    workspace_free(workspace);
 
-    // Calculate tag checksum
-    new_tag_header->checksum = byteswap32(crc32(0xFFFFFFFF, new_tag_buffer + sizeof(struct tag_header), new_tag_buffer_size - sizeof(struct tag_header)));
+    return true;
+}
 
-    // Save file
-    FILE *file_out;
-    file_out = fopen(output_path, "wb");
-    if(!file_out) {
-        fprintf(stderr, "Could not open %s for writing\n", output_path);
+static bool run_batch(const char *manifest_path, unsigned jobs) {
+    struct batch batch = {0};
+    if(!batch_read_manifest(&batch, manifest_path)) {
         return false;
     }
 
-    if(fwrite(new_tag_buffer, new_tag_buffer_size, 1, file_out) != 1) {
-        fprintf(stderr, "Could not write %zu bytes to %s\n", new_tag_buffer_size, output_path);
+    if(batch.jobs_count == 0) {
+        fprintf(stderr, "No jobs found in %s\n", manifest_path);
         return false;
     }
 
-    fclose(file_out);
-    free(new_tag_buffer);
-
-    return true;
-}
+    if(mtx_init(&batch.lock, mtx_plain) != thrd_success) {
+        fprintf(stderr, "Could not create batch lock\n");
+        batch_free(&batch);
+        return false;
+    }
 
-static void executable_basename(const char *path, char *name_buffer, size_t name_buffer_size) {
-#ifdef _WIN32
-    static char exe_base[256];
-    static char exe_ext[256];
-    auto split = _splitpath_s(path, nullptr, 0, nullptr, 0, exe_base, sizeof(exe_base), exe_ext, sizeof(exe_ext));
-    if(split) {
-        snprintf(name_buffer, name_buffer_size, "font-slicer");
-        return;
+    if(cnd_init(&batch.job_done) != thrd_success) {
+        fprintf(stderr, "Could not create batch condition\n");
+        mtx_destroy(&batch.lock);
+        batch_free(&batch);
+        return false;
     }
 
-    strncpy(name_buffer, exe_base, name_buffer_size);
-    strncat(name_buffer, exe_ext, name_buffer_size - strnlen(name_buffer, name_buffer_size));
-#else
-    char *executable_path = strdup(path);
-    if(!executable_path) {
-        snprintf(name_buffer, name_buffer_size, "font-slicer");
-        return;
+    // Every job gets one thread unless its own line says otherwise
+    if(jobs > batch.jobs_count) {
+        jobs = batch.jobs_count;
     }
 
-    char *name = basename(executable_path);
-    strncpy(name_buffer, name, name_buffer_size);
+    bool success = parallel_for(jobs, jobs, batch_worker_run, &batch);
+    success = success && batch.next_job >= batch.jobs_count;
 
-    free(executable_path);
-#endif
+    printf("%u of %u jobs succeeded\n", batch.jobs_count - batch.failed_jobs, batch.jobs_count);
+    success = success && batch.failed_jobs == 0;
+
+    cnd_destroy(&batch.job_done);
+    mtx_destroy(&batch.lock);
+    batch_free(&batch);
+
+    return success;
 }
 
 int main(int argc, const char **argv) {
-    if(argc != 4) {
-        error_usage:
+    struct command command;
+    if(argc < 2 || !parse_command(argc - 1, argv + 1, &command)) {
         char executable_name[256];
         executable_basename(argv[0], executable_name, sizeof(executable_name));
-        printf("Usage: %s <command> <command args>\nCommands:\n    split <input tag> <output dir>\n    join  <input dir> <new tag path>\n", executable_name);
+        printf("Usage: %s <command> [options] <command args>\nCommands:\n"
+               "    split <input tag> <output dir>  (- for a tar archive of the character files on stdout)\n"
+               "    join  <input dir> <new tag path>  (- to read a tar archive of character files from stdin, or write the tag to stdout)\n"
+               "    repack <input tag> <new tag path>  drop unused pixel data and store identical bitmaps once\n"
+               "    merge <base tag> <donor tag>... <new tag path>  lay characters from donor tags over the base tag, later donors win\n"
+               "    diff  <old tag> <new tag>  list the characters added, removed or changed, and changes to the font's own fields\n"
+               "    verify <tag or dir>...  check every font tag given or found under a directory, including checksums\n"
+               "    batch <manifest>  run every split/join/repack/merge line in a manifest (- for stdin)\n"
+               "Options:\n"
+               "    --bundle    split to / join from a single glyph bundle file instead of a directory\n"
+               "    --compress  split: write run length encoded <character>.binz files, which join reads like .bin files\n"
+               "    --incremental  join: only re-read character files that changed since the last join (uses <new tag path>.index)\n"
+               "    --dedup     join, merge: store identical bitmaps once\n"
+               "    --no-tables  join, repack, merge: leave out the character lookup tables, like invader-font does\n"
+               "    --ranges <list>  split: only extract these characters. merge: only take these characters from donors. Like 0x2000-0x206F,0x3000-0x303F\n"
+               "    --codepoints <list>  split, merge: same as --ranges but for single characters, like 0x2190,0x2192,65\n"
+               "    --stats     split, join, merge, diff: print how long each step took and what was read and written (--stats=json for JSON)\n"
+               "    --jobs <n>  number of threads to use (default 1). For batch and verify, the number of jobs or tags run at once\n", executable_name);
 
         return 1;
     }
 
-    const char *command = argv[1];
-    const char *input = argv[2];
-    const char *output = argv[3];
-
     bool success = false;
-
-    // Check what command
-    if(strcmp(command, "split") == 0) {
-        success = split_font_tag(input, output);
+    if(command.type == COMMAND_BATCH) {
+        success = run_batch(command.input, command.jobs);
     }
-    else if(strcmp(command, "join") == 0) {
-        success = produce_font_tag_from_bullshit(input, output);
+    else if(command.type == COMMAND_VERIFY) {
+        struct verify_options verify = { .jobs = command.jobs };
+        success = verify_font_tags(command.paths, command.paths_count, &verify);
     }
     else {
-        goto error_usage;
+        struct workspace *workspace = workspace_new();
+        if(workspace) {
+            success = run_command(&command, workspace);
+            workspace_free(workspace);
+        }
     }
 
     return success ? 0 : 1;
@@ -0,0 +1,102 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "mapped_file.h"
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+static bool read_whole_file(struct mapped_file *file, const char *path) {
+    FILE *file_in = fopen(path, "rb");
+    if(!file_in) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+
+    // Get size
+    fseek(file_in, 0, SEEK_END);
+    long file_in_size = ftell(file_in);
+    fseek(file_in, 0, SEEK_SET);
+    if(file_in_size < 0) {
+        fprintf(stderr, "Could not get the size of %s\n", path);
+        fclose(file_in);
+        return false;
+    }
+
+    // Read into buffer. Always allocate at least one byte so empty files still give a valid pointer
+    uint8_t *buffer = malloc(file_in_size ? file_in_size : 1);
+    if(!buffer) {
+        fprintf(stderr, "Could not allocate %ld bytes for input buffer\n", file_in_size);
+        fclose(file_in);
+        return false;
+    }
+
+    if(file_in_size != 0 && fread(buffer, file_in_size, 1, file_in) != 1) {
+        fprintf(stderr, "Could not read from %s\n", path);
+        free(buffer);
+        fclose(file_in);
+        return false;
+    }
+
+    fclose(file_in);
+
+    file->data = buffer;
+    file->size = file_in_size;
+    file->mapped = false;
+
+    return true;
+}
+
+bool mapped_file_open(struct mapped_file *file, const char *path) {
+    *file = (struct mapped_file){0};
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if(fd == -1) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data != MAP_FAILED) {
+            // Tags are always walked front to back
+            madvise(data, st.st_size, MADV_SEQUENTIAL);
+            close(fd);
+
+            file->data = data;
+            file->size = st.st_size;
+            file->mapped = true;
+
+            return true;
+        }
+    }
+
+    // Not something we can map, so just read it
+    close(fd);
+#endif
+
+    return read_whole_file(file, path);
+}
+
+void mapped_file_close(struct mapped_file *file) {
+#ifndef _WIN32
+    if(file->mapped) {
+        munmap((void *)file->data, file->size);
+    }
+    else
+#endif
+    {
+        free((void *)file->data);
+    }
+
+    *file = (struct mapped_file){0};
+}
@@ -0,0 +1,16 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Read-only view of a whole file. Memory mapped when possible, otherwise read into a buffer.
+struct mapped_file {
+    const uint8_t *data;
+    size_t size;
+    bool mapped;
+};
+
+bool mapped_file_open(struct mapped_file *file, const char *path);
+void mapped_file_close(struct mapped_file *file);
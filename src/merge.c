@@ -0,0 +1,186 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "font_tag.h"
+#include "mapped_file.h"
+#include "merge.h"
+#include "pixel_pack.h"
+#include "stats.h"
+
+// Which tag each character comes from, as the tag's number (0 is the base) and the character's index in it
+#define MERGE_OWNER(tag, index) (((uint32_t)(tag) << 16) | (index))
+#define MERGE_OWNER_TAG(owner) ((owner) >> 16)
+#define MERGE_OWNER_INDEX(owner) ((owner) & 0xFFFF)
+#define MERGE_OWNER_NONE UINT32_MAX
+
+struct merge_tag {
+    const char *path;
+    struct mapped_file file;
+    struct font_tag_layout layout;
+};
+
+bool merge_font_tags(const char *base_path, const char *const *donor_paths, uint32_t donors_count, const char *output_path, const struct merge_options *options, struct workspace *workspace) {
+    if(donors_count >= UINT16_MAX) {
+        fprintf(stderr, "Too many tags to merge\n");
+        return false;
+    }
+
+    uint32_t tags_count = donors_count + 1;
+    struct merge_tag *tags = calloc(tags_count, sizeof(struct merge_tag));
+    uint8_t *pixel_data = nullptr;
+    uint8_t *packed_pixel_data = nullptr;
+    char *temp_path = nullptr;
+    bool success = false;
+    if(!tags) {
+        fprintf(stderr, "Could not allocate merge tags\n");
+        return false;
+    }
+
+    stats_phase(workspace->stats, "map");
+    for(uint32_t t = 0; t < tags_count; t++) {
+        tags[t].path = t == 0 ? base_path : donor_paths[t - 1];
+        if(!mapped_file_open(&tags[t].file, tags[t].path) || !read_font_tag_layout(tags[t].path, tags[t].file.data, tags[t].file.size, &tags[t].layout)) {
+            goto cleanup;
+        }
+
+        stats_count(workspace->stats, STATS_FILES_OPENED, 1);
+        stats_count(workspace->stats, STATS_BYTES_READ, tags[t].file.size);
+    }
+
+    // Every character of the base, then whatever each donor has in range on top. Within a tag the first one wins, like split.
+    stats_phase(workspace->stats, "select");
+    uint32_t *owners = workspace->selected;
+    bool *seen = workspace->seen;
+    memset(owners, 0xFF, (UINT16_MAX + 1) * sizeof(uint32_t));
+    uint32_t owned_count = 0;
+    uint32_t replaced_count = 0;
+    uint32_t added_count = 0;
+    for(uint32_t t = 0; t < tags_count; t++) {
+        const struct font_tag_layout *layout = &tags[t].layout;
+        memset(seen, 0, (UINT16_MAX + 1) * sizeof(bool));
+        for(uint32_t i = 0; i < layout->characters_count; i++) {
+            uint16_t character = byteswap16(layout->characters[i].character);
+            if(seen[character] || (t != 0 && options->ranges && !character_ranges_contains(options->ranges, character))) {
+                continue;
+            }
+
+            seen[character] = true;
+            if(!character_pixels_in_bounds(&layout->characters[i], layout->pixel_data_size)) {
+                fprintf(stderr, "%s: Character %u has pixel data out of bounds\n", tags[t].path, character);
+                goto cleanup;
+            }
+
+            if(t != 0) {
+                if(owners[character] == MERGE_OWNER_NONE) {
+                    added_count++;
+                }
+                else if(MERGE_OWNER_TAG(owners[character]) == 0) {
+                    replaced_count++;
+                }
+            }
+
+            owned_count += owners[character] == MERGE_OWNER_NONE;
+            owners[character] = MERGE_OWNER(t, i);
+        }
+    }
+
+    // Every character from 0 to 65535 can't fit, since a tag counts its characters in 16 bits
+    if(owned_count > UINT16_MAX) {
+        fprintf(stderr, "The merged font would have %u characters, but a font tag can have at most %u\n", owned_count, UINT16_MAX);
+        goto cleanup;
+    }
+
+    // Lay the characters out in order like join does, with their pixels one after another
+    stats_phase(workspace->stats, "copy");
+    size_t pixel_data_size = 0;
+    for(uint32_t character = 0; character <= UINT16_MAX; character++) {
+        if(owners[character] != MERGE_OWNER_NONE) {
+            const struct font_character *owner = &tags[MERGE_OWNER_TAG(owners[character])].layout.characters[MERGE_OWNER_INDEX(owners[character])];
+            pixel_data_size += calculate_pixels_size(byteswap16(owner->bitmap_width), byteswap16(owner->bitmap_height));
+        }
+    }
+
+    pixel_data = malloc(pixel_data_size ? pixel_data_size : 1);
+    if(!pixel_data) {
+        fprintf(stderr, "Could not allocate %zu bytes for pixel data\n", pixel_data_size);
+        goto cleanup;
+    }
+
+    struct font_character *characters = workspace->characters;
+    uint32_t characters_count = 0;
+    size_t pixels_offset = 0;
+    for(uint32_t character = 0; character <= UINT16_MAX; character++) {
+        if(owners[character] == MERGE_OWNER_NONE) {
+            continue;
+        }
+
+        const struct font_tag_layout *layout = &tags[MERGE_OWNER_TAG(owners[character])].layout;
+        struct font_character *new_character = &characters[characters_count++];
+        *new_character = layout->characters[MERGE_OWNER_INDEX(owners[character])];
+        size_t pixels_size = calculate_pixels_size(byteswap16(new_character->bitmap_width), byteswap16(new_character->bitmap_height));
+        if(pixels_size != 0) {
+            memcpy(pixel_data + pixels_offset, layout->pixel_data + byteswap32(new_character->pixels_offset), pixels_size);
+        }
+        new_character->pixels_offset = byteswap32(pixels_offset);
+        pixels_offset += pixels_size;
+    }
+
+    const uint8_t *new_pixel_data = pixel_data;
+    size_t new_pixel_data_size = pixel_data_size;
+    if(options->dedup) {
+        stats_phase(workspace->stats, "pack");
+        packed_pixel_data = malloc(pixel_data_size ? pixel_data_size : 1);
+        struct pixel_pack_result packed;
+        if(!packed_pixel_data || !pack_pixels(characters, characters_count, pixel_data, packed_pixel_data, true, &packed)) {
+            fprintf(stderr, "Could not store identical bitmaps once\n");
+            goto cleanup;
+        }
+        new_pixel_data = packed_pixel_data;
+        new_pixel_data_size = packed.pixels_size;
+    }
+
+    // The inputs are still mapped, so write somewhere else first in case the output is one of them
+    stats_phase(workspace->stats, "write");
+    size_t output_path_length = strlen(output_path);
+    temp_path = malloc(output_path_length + sizeof(".tmp"));
+    if(!temp_path) {
+        fprintf(stderr, "Could not allocate path buffer\n");
+        goto cleanup;
+    }
+    snprintf(temp_path, output_path_length + sizeof(".tmp"), "%s.tmp", output_path);
+
+    uint8_t *character_tables = options->no_tables ? nullptr : workspace->character_tables;
+    if(!write_font_tag_from(&tags[0].layout, temp_path, characters, characters_count, new_pixel_data, new_pixel_data_size, character_tables, workspace->stats, nullptr)) {
+        goto cleanup;
+    }
+
+    for(uint32_t t = 0; t < tags_count; t++) {
+        mapped_file_close(&tags[t].file);
+    }
+#ifdef _WIN32
+    remove(output_path);
+#endif
+    if(rename(temp_path, output_path) != 0) {
+        fprintf(stderr, "Could not replace %s\n", output_path);
+        remove(temp_path);
+        goto cleanup;
+    }
+
+    printf("%s: %u characters, %u replaced and %u added from %u donor tag%s\n", output_path, characters_count, replaced_count, added_count, donors_count, donors_count == 1 ? "" : "s");
+    success = true;
+
+    cleanup:
+    for(uint32_t t = 0; t < tags_count; t++) {
+        mapped_file_close(&tags[t].file);
+    }
+    free(tags);
+    free(pixel_data);
+    free(packed_pixel_data);
+    free(temp_path);
+
+    return success;
+}
@@ -0,0 +1,17 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include "character_ranges.h"
+#include "workspace.h"
+
+struct merge_options {
+    const struct character_ranges *ranges; // only take these characters from the donors, or every character if null
+    bool dedup; // store identical bitmaps once
+    bool no_tables; // leave out the character lookup tables, like invader-font does
+};
+
+// Make a font tag from a base tag with characters from donor tags laid over it. Later donors win over earlier ones,
+// and every donor wins over the base. Everything but the characters and pixel data is kept from the base tag.
+// output_path can be one of the inputs.
+bool merge_font_tags(const char *base_path, const char *const *donor_paths, uint32_t donors_count, const char *output_path, const struct merge_options *options, struct workspace *workspace);
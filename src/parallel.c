@@ -0,0 +1,80 @@
+// Font Slicer, by Aerocatia
+
+#include <stdint.h>
+#include <threads.h>
+
+#include "parallel.h"
+
+static int parallel_range_run(void *arg) {
+    struct parallel_range *range = arg;
+    range->success = range->function(range->context, range->first, range->last);
+    return 0;
+}
+
+static void parallel_split(struct parallel_task *task, unsigned jobs, uint32_t count, parallel_function function, void *context) {
+    if(jobs > count) {
+        jobs = count;
+    }
+    if(jobs > PARALLEL_MAX_JOBS) {
+        jobs = PARALLEL_MAX_JOBS;
+    }
+    if(jobs < 1) {
+        jobs = 1;
+    }
+
+    task->jobs = jobs;
+    for(unsigned j = 0; j < jobs; j++) {
+        task->started[j] = false;
+        task->ranges[j] = (struct parallel_range) {
+            .function = function,
+            .context = context,
+            .first = (uint32_t)((uint64_t)count * j / jobs),
+            .last = (uint32_t)((uint64_t)count * (j + 1) / jobs)
+        };
+    }
+}
+
+static void parallel_start_from(struct parallel_task *task, unsigned first_job) {
+    for(unsigned j = first_job; j < task->jobs; j++) {
+        if(thrd_create(&task->threads[j], parallel_range_run, &task->ranges[j]) == thrd_success) {
+            task->started[j] = true;
+        }
+        else {
+            parallel_range_run(&task->ranges[j]);
+        }
+    }
+}
+
+void parallel_start(struct parallel_task *task, unsigned jobs, uint32_t count, parallel_function function, void *context) {
+    parallel_split(task, jobs, count, function, context);
+    parallel_start_from(task, 0);
+}
+
+bool parallel_finish(struct parallel_task *task) {
+    bool success = true;
+    for(unsigned j = 0; j < task->jobs; j++) {
+        if(task->started[j]) {
+            thrd_join(task->threads[j], nullptr);
+            task->started[j] = false;
+        }
+
+        success = success && task->ranges[j].success;
+    }
+
+    return success;
+}
+
+bool parallel_for(unsigned jobs, uint32_t count, parallel_function function, void *context) {
+    if(count == 0) {
+        return true;
+    }
+
+    struct parallel_task task;
+    parallel_split(&task, jobs, count, function, context);
+
+    // The first range always runs on this thread
+    parallel_start_from(&task, 1);
+    parallel_range_run(&task.ranges[0]);
+
+    return parallel_finish(&task);
+}
@@ -0,0 +1,37 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <threads.h>
+
+#define PARALLEL_MAX_JOBS 256
+
+// Handles items [first, last). Returns false on failure.
+typedef bool (*parallel_function)(void *context, uint32_t first, uint32_t last);
+
+struct parallel_range {
+    parallel_function function;
+    void *context;
+    uint32_t first;
+    uint32_t last;
+    bool success;
+};
+
+// Items split into even ranges, one per thread
+struct parallel_task {
+    unsigned jobs;
+    bool started[PARALLEL_MAX_JOBS];
+    thrd_t threads[PARALLEL_MAX_JOBS];
+    struct parallel_range ranges[PARALLEL_MAX_JOBS];
+};
+
+// Start running function over [0, count) on up to jobs background threads.
+// Ranges whose thread can not be started are run before this returns.
+void parallel_start(struct parallel_task *task, unsigned jobs, uint32_t count, parallel_function function, void *context);
+
+// Wait for a started task. Returns false if any range failed.
+bool parallel_finish(struct parallel_task *task);
+
+// Run function over [0, count) on up to jobs threads, including the calling thread
+bool parallel_for(unsigned jobs, uint32_t count, parallel_function function, void *context);
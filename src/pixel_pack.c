@@ -0,0 +1,83 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash.h"
+#include "pixel_pack.h"
+
+#define PIXEL_PACK_EMPTY UINT32_MAX
+
+bool pack_pixels(struct font_character *characters, uint32_t characters_count, const uint8_t *pixels_in, uint8_t *pixels_out, bool dedup, struct pixel_pack_result *result) {
+    *result = (struct pixel_pack_result){0};
+
+    // Open addressing table of character indices, at most half full
+    uint32_t *table = nullptr;
+    size_t table_mask = 0;
+    if(dedup) {
+        size_t table_size = 16;
+        while(table_size < (size_t)characters_count * 2) {
+            table_size *= 2;
+        }
+
+        table = malloc(table_size * sizeof(uint32_t));
+        if(!table) {
+            fprintf(stderr, "Could not allocate pixel hash table\n");
+            return false;
+        }
+
+        memset(table, 0xFF, table_size * sizeof(uint32_t));
+        table_mask = table_size - 1;
+    }
+
+    size_t pixels_out_size = 0;
+    for(uint32_t i = 0; i < characters_count; i++) {
+        struct font_character *character = &characters[i];
+        int16_t width = byteswap16(character->bitmap_width);
+        int16_t height = byteswap16(character->bitmap_height);
+        size_t pixels_size = calculate_pixels_size(width, height);
+        const uint8_t *pixels = pixels_in + byteswap32(character->pixels_offset);
+
+        // This is always set to the current position, even if there are no pixels
+        if(pixels_size == 0) {
+            character->pixels_offset = byteswap32(pixels_out_size);
+            continue;
+        }
+
+        if(dedup) {
+            uint64_t dimensions = ((uint64_t)(uint16_t)width << 16) | (uint16_t)height;
+            size_t slot = hash64(pixels, pixels_size, dimensions) & table_mask;
+            bool shared = false;
+            while(table[slot] != PIXEL_PACK_EMPTY) {
+                // Already packed, so its offset points into pixels_out
+                const struct font_character *other = &characters[table[slot]];
+                if(other->bitmap_width == character->bitmap_width && other->bitmap_height == character->bitmap_height &&
+                   memcmp(pixels_out + byteswap32(other->pixels_offset), pixels, pixels_size) == 0) {
+                    character->pixels_offset = other->pixels_offset;
+                    result->shared_characters++;
+                    result->bytes_saved += pixels_size;
+                    shared = true;
+                    break;
+                }
+                slot = (slot + 1) & table_mask;
+            }
+
+            if(shared) {
+                continue;
+            }
+
+            table[slot] = i;
+        }
+
+        memcpy(pixels_out + pixels_out_size, pixels, pixels_size);
+        character->pixels_offset = byteswap32(pixels_out_size);
+        pixels_out_size += pixels_size;
+    }
+
+    free(table);
+    result->pixels_size = pixels_out_size;
+
+    return true;
+}
@@ -0,0 +1,20 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "font.h"
+
+struct pixel_pack_result {
+    size_t pixels_size; // bytes written to pixels_out
+    uint32_t shared_characters; // characters pointed at an earlier identical bitmap
+    size_t bytes_saved;
+};
+
+// Copy the pixels of each character (pixels_offset relative to pixels_in) into pixels_out in character order
+// and rewrite pixels_offset to match. With dedup, a bitmap with the same size and bytes as an earlier one is
+// not copied again, and the character points at the earlier copy instead.
+// pixels_out must fit every character's pixels. Returns false if it can't allocate its hash table.
+bool pack_pixels(struct font_character *characters, uint32_t characters_count, const uint8_t *pixels_in, uint8_t *pixels_out, bool dedup, struct pixel_pack_result *result);
@@ -0,0 +1,94 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "font_tag.h"
+#include "glyph_set.h"
+#include "mapped_file.h"
+#include "pixel_pack.h"
+#include "repack.h"
+
+// Rewrite a font tag with only the pixel data its characters use, storing identical bitmaps once.
+// Character tables are rebuilt to match the characters. Everything else, including character order and style font names, is kept as is.
+bool repack_font_tag(const char *tag_path, const char *output_path, const struct repack_options *options, struct workspace *workspace) {
+    struct mapped_file file_in;
+    if(!mapped_file_open(&file_in, tag_path)) {
+        return false;
+    }
+
+    uint8_t *packed_pixel_data = nullptr;
+    char *temp_path = nullptr;
+    bool success = false;
+
+    struct font_tag_layout tag;
+    if(!read_font_tag_layout(tag_path, file_in.data, file_in.size, &tag)) {
+        goto cleanup;
+    }
+
+    // Offsets are rewritten in place, so work on a copy of the characters
+    struct font_character *characters = workspace->characters;
+    memcpy(characters, tag.characters, tag.characters_count * sizeof(struct font_character));
+    struct glyph_set *glyphs = &workspace->glyphs;
+    glyph_set_decode(glyphs, characters, tag.characters_count);
+    for(uint32_t i = 0; i < tag.characters_count; i++) {
+        if(!glyph_set_pixels_in_bounds(glyphs, i, tag.pixel_data_size)) {
+            fprintf(stderr, "%s: Character %u has pixel data out of bounds\n", tag_path, glyphs->character[i]);
+            goto cleanup;
+        }
+    }
+
+    struct glyph_metrics metrics;
+    glyph_set_metrics(glyphs, &metrics);
+    size_t unpacked_size = metrics.pixels_size;
+
+    packed_pixel_data = malloc(unpacked_size ? unpacked_size : 1);
+    if(!packed_pixel_data) {
+        fprintf(stderr, "Could not allocate %zu bytes for pixel data\n", unpacked_size);
+        goto cleanup;
+    }
+
+    struct pixel_pack_result packed;
+    if(!pack_pixels(characters, tag.characters_count, tag.pixel_data, packed_pixel_data, true, &packed)) {
+        goto cleanup;
+    }
+
+    // The input is still mapped, so write somewhere else first in case the output is the same file
+    size_t output_path_length = strlen(output_path);
+    temp_path = malloc(output_path_length + sizeof(".tmp"));
+    if(!temp_path) {
+        fprintf(stderr, "Could not allocate path buffer\n");
+        goto cleanup;
+    }
+    snprintf(temp_path, output_path_length + sizeof(".tmp"), "%s.tmp", output_path);
+
+    uint8_t *character_tables = options->no_tables ? nullptr : workspace->character_tables;
+    size_t size_before = file_in.size;
+    size_t size_after;
+    if(!write_font_tag_from(&tag, temp_path, characters, tag.characters_count, packed_pixel_data, packed.pixels_size, character_tables, workspace->stats, &size_after)) {
+        goto cleanup;
+    }
+
+    mapped_file_close(&file_in);
+#ifdef _WIN32
+    remove(output_path);
+#endif
+    if(rename(temp_path, output_path) != 0) {
+        fprintf(stderr, "Could not replace %s\n", output_path);
+        remove(temp_path);
+        goto cleanup;
+    }
+
+    printf("%s: %zu -> %zu bytes (pixel data %zu -> %zu bytes, %u characters share pixel data with another character)\n",
+           output_path, size_before, size_after, tag.pixel_data_size, packed.pixels_size, packed.shared_characters);
+    success = true;
+
+    cleanup:
+    mapped_file_close(&file_in);
+    free(packed_pixel_data);
+    free(temp_path);
+
+    return success;
+}
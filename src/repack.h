@@ -0,0 +1,13 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include "workspace.h"
+
+struct repack_options {
+    bool no_tables; // drop the character lookup tables instead of rebuilding them
+};
+
+// Rewrite a font tag with only the pixel data its characters use, storing identical bitmaps once. output_path can be
+// the input.
+bool repack_font_tag(const char *tag_path, const char *output_path, const struct repack_options *options, struct workspace *workspace);
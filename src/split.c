@@ -0,0 +1,325 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "character_rle.h"
+#include "character_tar.h"
+#include "font_tag.h"
+#include "glyph_bundle.h"
+#include "glyph_set.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "split.h"
+#include "stats.h"
+
+#ifdef _WIN32
+    #include <direct.h>
+    #include <fcntl.h>
+    #include <io.h>
+    #define MKDIR(path, mode) _mkdir(path)
+#else
+    #define MKDIR(path, mode) mkdir(path, mode)
+#endif
+
+static int compare_characters(const void *a, const void *b) {
+    uint16_t value_a = *(const uint16_t *)a;
+    uint16_t value_b = *(const uint16_t *)b;
+
+    if(value_a < value_b) {
+        return -1;
+    }
+    else if (value_a > value_b) {
+        return 1;
+    }
+
+    return 0;
+}
+
+// Pick which characters get extracted. Duplicates are skipped and the first one wins, and with ranges only characters
+// in them are looked at. The picked characters are copied in tag order to the workspace's characters, with their indices
+// in the tag in its selected list, and decoded into its glyph set. Nothing else about other characters is read. Fails if
+// ranges leave nothing to extract.
+static bool select_characters(const struct font_character *characters, uint32_t characters_count, size_t pixel_data_size, const struct character_ranges *ranges, struct workspace *workspace, uint32_t *selected_count) {
+    bool *seen = workspace->seen;
+    uint32_t *selected = workspace->selected;
+    memset(seen, 0, (UINT16_MAX + 1) * sizeof(bool));
+
+    *selected_count = 0;
+    for(uint32_t i = 0; i < characters_count; i++) {
+        uint16_t character_type = byteswap16(characters[i].character);
+        if(ranges && !character_ranges_contains(ranges, character_type)) {
+            continue;
+        }
+
+        if(seen[character_type]) {
+            fprintf(stderr, "Warning: skipped extracting duplicate character %u at index %u\n", character_type, i);
+            stats_count(workspace->stats, STATS_DUPLICATES_SKIPPED, 1);
+            continue;
+        }
+
+        seen[character_type] = true;
+        workspace->characters[*selected_count] = characters[i];
+        selected[(*selected_count)++] = i;
+    }
+
+    // A typo in a range would otherwise look like a refresh that worked
+    if(*selected_count == 0) {
+        fprintf(stderr, "None of the characters in the tag are in ");
+        character_ranges_print(stderr, ranges);
+        fprintf(stderr, "\n");
+        return false;
+    }
+
+    const struct glyph_set *glyphs = &workspace->glyphs;
+    glyph_set_decode(&workspace->glyphs, workspace->characters, *selected_count);
+    for(uint32_t s = 0; s < *selected_count; s++) {
+        if(!glyph_set_pixels_in_bounds(glyphs, s, pixel_data_size)) {
+            fprintf(stderr, "Pixel data for character %u is out of bounds\n", selected[s]);
+            return false;
+        }
+
+        if(glyph_set_pixels_size(glyphs, s) == 0) {
+            fprintf(stderr, "Warning: character %u has no pixel data\n", selected[s]);
+            stats_count(workspace->stats, STATS_EMPTY_GLYPHS, 1);
+        }
+    }
+
+    return true;
+}
+
+struct split_worker {
+    const struct font_character *characters;
+    const struct glyph_set *glyphs;
+    const uint8_t *pixel_data;
+    const char *output_dir;
+    bool compress;
+    struct stats *stats;
+};
+
+// Dump tag data + pixel data to a file for each selected character in [first, last)
+static bool split_worker_run(void *context, uint32_t first, uint32_t last) {
+    const struct split_worker *worker = context;
+
+    // Output buffer
+    size_t buffer_out_size = 1 * 1024 * 1024;
+    uint8_t *buffer_out = malloc(buffer_out_size);
+    if(!buffer_out) {
+        fprintf(stderr, "Could not allocate %zu bytes for output buffer\n", buffer_out_size);
+        return false;
+    }
+
+    char output_path[512];
+    for(uint32_t i = first; i < last; i++) {
+        snprintf(output_path, sizeof(output_path), "%s/%u.%s", worker->output_dir, worker->glyphs->character[i], worker->compress ? "binz" : "bin");
+        size_t pixels_size = glyph_set_pixels_size(worker->glyphs, i);
+        const uint8_t *pixels = worker->pixel_data + worker->glyphs->pixels_offset[i];
+
+        // Copy file data to save
+        size_t character_file_size = worker->compress ? sizeof(struct character_rle_header) + character_rle_bound(pixels_size) : sizeof(struct font_character) + pixels_size;
+        if(character_file_size > buffer_out_size) {
+            fprintf(stderr, "Character %u is too large for output buffer\n", worker->glyphs->character[i]);
+            free(buffer_out);
+            return false;
+        }
+
+        // The character is copied as it is in the tag, so anything the glyph set leaves out is kept
+        struct font_character *character_out;
+        if(worker->compress) {
+            struct character_rle_header *header = (struct character_rle_header *)buffer_out;
+            *header = (struct character_rle_header) {
+                .signature = byteswap32(CHARACTER_RLE_SIGNATURE),
+                .version = byteswap16(CHARACTER_RLE_VERSION),
+                .size = byteswap32(sizeof(struct font_character) + pixels_size),
+                .character = worker->characters[i]
+            };
+            character_out = &header->character;
+            character_file_size = sizeof(struct character_rle_header) + character_rle_encode(pixels, pixels_size, buffer_out + sizeof(struct character_rle_header));
+        }
+        else {
+            character_out = (struct font_character *)buffer_out;
+            *character_out = worker->characters[i];
+            if(pixels_size != 0) {
+                memcpy(buffer_out + sizeof(struct font_character), pixels, pixels_size);
+            }
+        }
+
+        // Clear stale pixel data offset
+        character_out->pixels_offset = 0;
+
+        // Save file
+        FILE *file_out;
+        file_out = fopen(output_path, "wb");
+        if(!file_out) {
+            fprintf(stderr, "Could not open %s for writing\n", output_path);
+            free(buffer_out);
+            return false;
+        }
+
+        if(fwrite(buffer_out, character_file_size, 1, file_out) != 1) {
+            fprintf(stderr, "Could not write %zu bytes to %s\n", character_file_size, output_path);
+            fclose(file_out);
+            free(buffer_out);
+            return false;
+        }
+
+        fclose(file_out);
+        stats_count(worker->stats, STATS_FILES_OPENED, 1);
+        stats_count(worker->stats, STATS_BYTES_WRITTEN, character_file_size);
+    }
+
+    free(buffer_out);
+
+    return true;
+}
+
+static bool split_to_directory(const struct font_tag_layout *tag, const char *output_dir, const struct split_options *options, struct workspace *workspace) {
+    // Work out what to write before making or writing anything, so duplicates are handled the same for any number of jobs
+    stats_phase(workspace->stats, "select");
+    uint32_t selected_count = 0;
+    if(!select_characters(tag->characters, tag->characters_count, tag->pixel_data_size, options->ranges, workspace, &selected_count)) {
+        return false;
+    }
+
+    // Check output directory exists, make it if not (parent must exist)
+    struct stat st = {0};
+    if(stat(output_dir, &st) == -1) {
+        if(MKDIR(output_dir, 0777) == -1) {
+            fprintf(stderr, "Error creating directory %s\n", output_dir);
+            return false;
+        }
+    }
+    else if(!S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "Output %s is not a valid directory path\n", output_dir);
+        return false;
+    }
+
+    // Writing is mostly filesystem metadata work, so give each job an even share of files
+    struct split_worker worker = {
+        .characters = workspace->characters,
+        .glyphs = &workspace->glyphs,
+        .pixel_data = tag->pixel_data,
+        .output_dir = output_dir,
+        .compress = options->compress,
+        .stats = workspace->stats
+    };
+
+    stats_phase(workspace->stats, "write");
+    return parallel_for(options->jobs, selected_count, split_worker_run, &worker);
+}
+
+static int compare_font_characters(const void *a, const void *b) {
+    uint16_t value_a = byteswap16(((const struct font_character *)a)->character);
+    uint16_t value_b = byteswap16(((const struct font_character *)b)->character);
+    return compare_characters(&value_a, &value_b);
+}
+
+static bool split_to_bundle(const struct font_tag_layout *tag, const char *output_path, const struct split_options *options, struct workspace *workspace) {
+    // Same rules as splitting to a directory
+    stats_phase(workspace->stats, "select");
+    uint32_t selected_count = 0;
+    if(!select_characters(tag->characters, tag->characters_count, tag->pixel_data_size, options->ranges, workspace, &selected_count)) {
+        return false;
+    }
+
+    // Bundles are sorted so single characters can be found with a binary search
+    stats_phase(workspace->stats, "sort");
+    struct font_character *bundle_characters = workspace->characters;
+    qsort(bundle_characters, selected_count, sizeof(struct font_character), compare_font_characters);
+
+    stats_phase(workspace->stats, "write");
+    if(!glyph_bundle_write(output_path, bundle_characters, selected_count, tag->pixel_data)) {
+        return false;
+    }
+
+    struct stat st;
+    if(workspace->stats && stat(output_path, &st) == 0) {
+        stats_count(workspace->stats, STATS_FILES_OPENED, 1);
+        stats_count(workspace->stats, STATS_BYTES_WRITTEN, st.st_size);
+    }
+
+    return true;
+}
+
+// Write the characters to stdout as a tar archive of character files
+static bool split_to_stream(const struct font_tag_layout *tag, const struct split_options *options, struct workspace *workspace) {
+    stats_phase(workspace->stats, "select");
+    uint32_t selected_count = 0;
+    if(!select_characters(tag->characters, tag->characters_count, tag->pixel_data_size, options->ranges, workspace, &selected_count)) {
+        return false;
+    }
+
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    // Character files are small, so batch them into big writes
+    setvbuf(stdout, nullptr, _IOFBF, 1 * 1024 * 1024);
+
+    stats_phase(workspace->stats, "write");
+    const struct glyph_set *glyphs = &workspace->glyphs;
+    for(uint32_t i = 0; i < selected_count; i++) {
+        size_t pixels_size = glyph_set_pixels_size(glyphs, i);
+        const uint8_t *pixels = pixels_size ? tag->pixel_data + glyphs->pixels_offset[i] : nullptr;
+        size_t written = character_tar_write(stdout, &workspace->characters[i], pixels, pixels_size);
+        if(written == 0) {
+            fprintf(stderr, "Could not write character %u to stdout\n", glyphs->character[i]);
+            return false;
+        }
+
+        stats_count(workspace->stats, STATS_BYTES_WRITTEN, written);
+    }
+
+    if(!character_tar_end(stdout) || fflush(stdout) != 0) {
+        fprintf(stderr, "Could not write to stdout\n");
+        return false;
+    }
+
+    stats_count(workspace->stats, STATS_BYTES_WRITTEN, CHARACTER_TAR_BLOCK_SIZE * 2);
+
+    return true;
+}
+
+bool split_font_tag(const char *tag_path, const char *output, const struct split_options *options, struct workspace *workspace) {
+    // Map the font tag. Everything below reads straight from the mapping
+    stats_phase(workspace->stats, "map");
+    struct mapped_file file_in;
+    if(!mapped_file_open(&file_in, tag_path)) {
+        return false;
+    }
+
+    stats_count(workspace->stats, STATS_FILES_OPENED, 1);
+    stats_count(workspace->stats, STATS_BYTES_READ, file_in.size);
+
+    struct font_tag_layout tag;
+    bool success = read_font_tag_layout(tag_path, file_in.data, file_in.size, &tag);
+    if(success && strcmp(output, "-") == 0) {
+        if(options->bundle) {
+            fprintf(stderr, "--bundle can't be written to stdout\n");
+            success = false;
+        }
+        else if(options->compress) {
+            fprintf(stderr, "--compress can't be written to stdout\n");
+            success = false;
+        }
+        else {
+            success = split_to_stream(&tag, options, workspace);
+        }
+    }
+    else if(success && options->bundle && options->compress) {
+        fprintf(stderr, "--compress can't be used with --bundle\n");
+        success = false;
+    }
+    else if(success && options->bundle) {
+        success = split_to_bundle(&tag, output, options, workspace);
+    }
+    else if(success) {
+        success = split_to_directory(&tag, output, options, workspace);
+    }
+
+    mapped_file_close(&file_in);
+
+    return success;
+}
@@ -0,0 +1,18 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include "character_ranges.h"
+#include "workspace.h"
+
+struct split_options {
+    bool bundle; // write a glyph bundle instead of a directory of character files
+    bool compress; // write run length encoded <character>.binz files instead of .bin
+    unsigned jobs; // number of threads writing character files
+    const struct character_ranges *ranges; // only extract these characters, or every character if null
+};
+
+// Extract the characters of a font tag into a directory of <character>.bin files, or a glyph bundle. If output is -,
+// the character files are written to stdout as a tar archive instead. Other files already in a directory are left
+// alone, so a few characters can be refreshed with ranges.
+bool split_font_tag(const char *tag_path, const char *output, const struct split_options *options, struct workspace *workspace);
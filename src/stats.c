@@ -0,0 +1,130 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "stats.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+static const char *counter_names[STATS_COUNTER_COUNT] = {
+    "files_opened",
+    "bytes_read",
+    "bytes_written",
+    "empty_glyphs",
+    "duplicates_skipped"
+};
+
+double monotonic_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+// Most memory the whole process has used so far
+static uint64_t peak_memory(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if(!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    #ifdef __APPLE__
+        return usage.ru_maxrss;
+    #else
+        return (uint64_t)usage.ru_maxrss * 1024;
+    #endif
+#endif
+}
+
+void stats_start(struct stats *stats, enum stats_format format, const char *command) {
+    *stats = (struct stats){ .format = format, .command = command, .output = stdout };
+    for(int c = 0; c < STATS_COUNTER_COUNT; c++) {
+        atomic_init(&stats->counters[c], 0);
+    }
+
+    stats->start = monotonic_seconds();
+    stats->phase_start = stats->start;
+}
+
+static void stats_end_phase(struct stats *stats, double now) {
+    if(stats->phases_count > 0) {
+        stats->phase_seconds[stats->phases_count - 1] += now - stats->phase_start;
+    }
+    stats->phase_start = now;
+}
+
+void stats_phase(struct stats *stats, const char *name) {
+    if(!stats) {
+        return;
+    }
+
+    stats_end_phase(stats, monotonic_seconds());
+
+    // A phase that comes up again keeps adding to its time
+    for(int p = 0; p < stats->phases_count; p++) {
+        if(strcmp(stats->phase_names[p], name) == 0) {
+            return;
+        }
+    }
+
+    if(stats->phases_count < STATS_MAX_PHASES) {
+        stats->phase_names[stats->phases_count] = name;
+        stats->phase_seconds[stats->phases_count] = 0;
+        stats->phases_count++;
+    }
+}
+
+void stats_finish(struct stats *stats, bool success) {
+    if(!stats) {
+        return;
+    }
+
+    double now = monotonic_seconds();
+    stats_end_phase(stats, now);
+    double total_seconds = now - stats->start;
+    uint64_t memory = peak_memory();
+
+    if(stats->format == STATS_JSON) {
+        fprintf(stats->output, "{\"command\":\"%s\",\"success\":%s,\"phases\":{", stats->command, success ? "true" : "false");
+        for(int p = 0; p < stats->phases_count; p++) {
+            fprintf(stats->output, "%s\"%s\":%.6f", p ? "," : "", stats->phase_names[p], stats->phase_seconds[p]);
+        }
+        fprintf(stats->output, "},\"checksum_seconds\":%.6f,\"total_seconds\":%.6f", stats->checksum_seconds, total_seconds);
+        for(int c = 0; c < STATS_COUNTER_COUNT; c++) {
+            fprintf(stats->output, ",\"%s\":%llu", counter_names[c], (unsigned long long)atomic_load(&stats->counters[c]));
+        }
+        fprintf(stats->output, ",\"peak_memory_bytes\":%llu}\n", (unsigned long long)memory);
+    }
+    else {
+        fprintf(stats->output, "%s stats:\n", stats->command);
+        for(int p = 0; p < stats->phases_count; p++) {
+            fprintf(stats->output, "    %-20s %12.3f ms\n", stats->phase_names[p], stats->phase_seconds[p] * 1e3);
+        }
+        fprintf(stats->output, "    %-20s %12.3f ms\n", "(checksum)", stats->checksum_seconds * 1e3);
+        fprintf(stats->output, "    %-20s %12.3f ms\n", "total", total_seconds * 1e3);
+        for(int c = 0; c < STATS_COUNTER_COUNT; c++) {
+            fprintf(stats->output, "    %-20s %12llu\n", counter_names[c], (unsigned long long)atomic_load(&stats->counters[c]));
+        }
+        fprintf(stats->output, "    %-20s %12llu\n", "peak_memory_bytes", (unsigned long long)memory);
+    }
+}
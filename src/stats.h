@@ -0,0 +1,55 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+enum stats_format {
+    STATS_NONE,
+    STATS_TEXT,
+    STATS_JSON
+};
+
+enum stats_counter {
+    STATS_FILES_OPENED,
+    STATS_BYTES_READ,
+    STATS_BYTES_WRITTEN,
+    STATS_EMPTY_GLYPHS,
+    STATS_DUPLICATES_SKIPPED,
+    STATS_COUNTER_COUNT
+};
+
+#define STATS_MAX_PHASES 8
+
+// Timings and counters for one command. Phases run one after another, but counters can be added to from any thread.
+struct stats {
+    enum stats_format format;
+    FILE *output; // stdout, unless that is where the command writes its output
+    const char *command;
+    double start;
+    double phase_start;
+    int phases_count;
+    const char *phase_names[STATS_MAX_PHASES];
+    double phase_seconds[STATS_MAX_PHASES];
+    double checksum_seconds; // part of whichever phase wrote the tag
+    atomic_uint_least64_t counters[STATS_COUNTER_COUNT];
+};
+
+double monotonic_seconds(void);
+
+void stats_start(struct stats *stats, enum stats_format format, const char *command);
+
+// End the current phase, if any, and start the next one. Does nothing if stats is null, as do the rest.
+void stats_phase(struct stats *stats, const char *name);
+
+static inline void stats_count(struct stats *stats, enum stats_counter counter, uint64_t value) {
+    if(stats) {
+        atomic_fetch_add_explicit(&stats->counters[counter], value, memory_order_relaxed);
+    }
+}
+
+// End the last phase and print everything
+void stats_finish(struct stats *stats, bool success);
@@ -0,0 +1,172 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crc32.h"
+#include "tag_writer.h"
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+static bool tag_writer_to_stdout(const struct tag_writer *writer) {
+    return writer->buffer != nullptr;
+}
+
+static bool buffer_append(struct tag_writer *writer, const void *data, size_t size) {
+    if(writer->buffer_capacity - writer->size < size) {
+        size_t capacity = writer->buffer_capacity ? writer->buffer_capacity : 1 * 1024 * 1024;
+        while(capacity - writer->size < size) {
+            capacity *= 2;
+        }
+
+        uint8_t *buffer = realloc(writer->buffer, capacity);
+        if(!buffer) {
+            fprintf(stderr, "Could not allocate %zu bytes for the tag\n", capacity);
+            return false;
+        }
+        writer->buffer = buffer;
+        writer->buffer_capacity = capacity;
+    }
+
+    memcpy(writer->buffer + writer->size, data, size);
+
+    return true;
+}
+
+bool tag_writer_open(struct tag_writer *writer, const char *path, const struct tag_header *header) {
+    *writer = (struct tag_writer){0};
+    writer->path = path;
+    writer->crc = 0xFFFFFFFF;
+
+    // Checksum isn't known yet, so it goes in last
+    struct tag_header placeholder = *header;
+    placeholder.checksum = 0;
+    if(strcmp(path, "-") == 0) {
+        if(!buffer_append(writer, &placeholder, sizeof(placeholder))) {
+            tag_writer_abort(writer);
+            return false;
+        }
+        writer->size = sizeof(placeholder);
+        writer->success = true;
+
+        return true;
+    }
+
+    writer->file = fopen(path, "wb");
+    if(!writer->file) {
+        fprintf(stderr, "Could not open %s for writing\n", path);
+        return false;
+    }
+
+    // Characters and pixels come in small pieces
+    setvbuf(writer->file, nullptr, _IOFBF, 1 * 1024 * 1024);
+
+    writer->success = true;
+    if(fwrite(&placeholder, sizeof(placeholder), 1, writer->file) != 1) {
+        fprintf(stderr, "Could not write tag header to %s\n", path);
+        tag_writer_abort(writer);
+        return false;
+    }
+    writer->size = sizeof(placeholder);
+
+    return true;
+}
+
+bool tag_writer_write(struct tag_writer *writer, const void *data, size_t size) {
+    if(!writer->success || size == 0) {
+        return writer->success;
+    }
+
+    if(writer->stats) {
+        double start = monotonic_seconds();
+        writer->crc = crc32(writer->crc, data, size);
+        writer->stats->checksum_seconds += monotonic_seconds() - start;
+    }
+    else {
+        writer->crc = crc32(writer->crc, data, size);
+    }
+    if(tag_writer_to_stdout(writer)) {
+        writer->success = buffer_append(writer, data, size);
+    }
+    else if(fwrite(data, size, 1, writer->file) != 1) {
+        fprintf(stderr, "Could not write %zu bytes to %s\n", size, writer->path);
+        writer->success = false;
+    }
+    writer->size += size;
+
+    return writer->success;
+}
+
+bool tag_writer_close(struct tag_writer *writer) {
+    if(!writer->success) {
+        tag_writer_abort(writer);
+        return false;
+    }
+
+    uint32_t checksum = byteswap32(writer->crc);
+    size_t checksum_offset = offsetof(struct tag_header, checksum);
+    if(tag_writer_to_stdout(writer)) {
+        memcpy(writer->buffer + checksum_offset, &checksum, sizeof(checksum));
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        if(fwrite(writer->buffer, writer->size, 1, stdout) != 1 || fflush(stdout) != 0) {
+            fprintf(stderr, "Could not write the tag to stdout\n");
+            tag_writer_abort(writer);
+            return false;
+        }
+
+        stats_count(writer->stats, STATS_BYTES_WRITTEN, writer->size);
+        free(writer->buffer);
+        *writer = (struct tag_writer){0};
+
+        return true;
+    }
+
+    bool patched;
+    if(fflush(writer->file) != 0) {
+        patched = false;
+    }
+    else {
+#ifdef _WIN32
+        patched = fseek(writer->file, checksum_offset, SEEK_SET) == 0 && fwrite(&checksum, sizeof(checksum), 1, writer->file) == 1;
+#else
+        patched = pwrite(fileno(writer->file), &checksum, sizeof(checksum), checksum_offset) == sizeof(checksum);
+#endif
+    }
+
+    if(fclose(writer->file) != 0 || !patched) {
+        fprintf(stderr, "Could not finish writing %s\n", writer->path);
+        writer->file = nullptr;
+        tag_writer_abort(writer);
+        return false;
+    }
+
+    stats_count(writer->stats, STATS_FILES_OPENED, 1);
+    stats_count(writer->stats, STATS_BYTES_WRITTEN, writer->size);
+    *writer = (struct tag_writer){0};
+
+    return true;
+}
+
+void tag_writer_abort(struct tag_writer *writer) {
+    if(writer->file) {
+        fclose(writer->file);
+    }
+
+    if(writer->path && strcmp(writer->path, "-") != 0) {
+        remove(writer->path);
+    }
+
+    free(writer->buffer);
+
+    *writer = (struct tag_writer){0};
+}
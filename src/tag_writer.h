@@ -0,0 +1,34 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "font.h"
+#include "stats.h"
+
+// Writes a tag front to back, keeping a running checksum of everything after the header.
+// The checksum is patched into the header when the tag is closed. A path of - writes the tag to stdout, which can't
+// be patched, so there the whole tag is kept in memory until it is closed.
+struct tag_writer {
+    FILE *file;
+    uint8_t *buffer; // the tag so far, when writing to stdout
+    size_t buffer_capacity;
+    const char *path;
+    uint32_t crc;
+    size_t size; // bytes written so far, including the header
+    struct stats *stats; // optional. Gets the bytes written and the time spent on the checksum
+    bool success;
+};
+
+bool tag_writer_open(struct tag_writer *writer, const char *path, const struct tag_header *header);
+bool tag_writer_write(struct tag_writer *writer, const void *data, size_t size);
+
+// Patch the checksum and close. If anything failed, the partial file is removed.
+// Nothing goes to stdout unless the whole tag was written.
+bool tag_writer_close(struct tag_writer *writer);
+
+// Close and remove the partial file
+void tag_writer_abort(struct tag_writer *writer);
@@ -0,0 +1,257 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "character_tables.h"
+#include "font_tag.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "stats.h"
+#include "verify.h"
+
+// Linked directories aren't followed, so a link back up the tree can't make the scan go on forever
+#ifdef _WIN32
+    #define LSTAT(path, st) stat(path, st)
+#else
+    #define LSTAT(path, st) lstat(path, st)
+#endif
+
+bool verify_font_tag(const char *tag_path, const uint8_t *tag_data, size_t tag_size) {
+    struct font_tag_layout layout;
+    if(!read_font_tag_layout(tag_path, tag_data, tag_size, &layout)) {
+        return false;
+    }
+
+    // One bit per character, to find any that are there twice
+    uint64_t present[(UINT16_MAX + 1) / 64] = {0};
+    uint32_t out_of_bounds_count = 0;
+    uint32_t duplicates_count = 0;
+    uint16_t first_out_of_bounds = 0;
+    uint16_t first_duplicate = 0;
+    for(uint32_t i = 0; i < layout.characters_count; i++) {
+        const struct font_character *character = &layout.characters[i];
+        uint16_t code = byteswap16(character->character);
+        if(!character_pixels_in_bounds(character, layout.pixel_data_size) && out_of_bounds_count++ == 0) {
+            first_out_of_bounds = code;
+        }
+
+        uint64_t bit = (uint64_t)1 << (code % 64);
+        if((present[code / 64] & bit) && duplicates_count++ == 0) {
+            first_duplicate = code;
+        }
+        present[code / 64] |= bit;
+    }
+
+    bool valid = true;
+    if(out_of_bounds_count != 0) {
+        fprintf(stderr, "%s has %u characters with pixel data out of bounds, starting with %u\n", tag_path, out_of_bounds_count, first_out_of_bounds);
+        valid = false;
+    }
+
+    if(duplicates_count != 0) {
+        fprintf(stderr, "%s has %u characters that are in it more than once, starting with %u\n", tag_path, duplicates_count, first_duplicate);
+        valid = false;
+    }
+
+    // Tables are optional, but if they are there the game uses them instead of searching, so every character has to be
+    // found through them and every index in them has to point at its own character
+    if(layout.character_tables_count != 0 && !layout.character_tables_usable) {
+        fprintf(stderr, "%s has character tables the game can't use (more than %u, or not %u entries each)\n", tag_path, CHARACTER_TABLES_MAX_COUNT, CHARACTER_TABLE_SIZE);
+        valid = false;
+    }
+    else if(layout.character_tables_count != 0) {
+        uint32_t mismatches_count = 0;
+        uint16_t first_mismatch = 0;
+        for(uint32_t code = 0; code <= UINT16_MAX; code++) {
+            uint32_t table = code >> 8;
+            uint16_t index = CHARACTER_TABLE_EMPTY;
+            if(table < layout.character_tables_count && layout.character_tables[table].table.count != 0) {
+                index = byteswap16(layout.character_table_data[layout.character_table_starts[table] + (code & 0xFF)].character_index);
+            }
+
+            bool matches;
+            if(index == CHARACTER_TABLE_EMPTY) {
+                matches = (present[code / 64] & ((uint64_t)1 << (code % 64))) == 0;
+            }
+            else {
+                matches = index < layout.characters_count && byteswap16(layout.characters[index].character) == code;
+            }
+
+            if(!matches && mismatches_count++ == 0) {
+                first_mismatch = code;
+            }
+        }
+
+        if(mismatches_count != 0) {
+            fprintf(stderr, "%s has character tables that don't match its characters for %u characters, starting with %u\n", tag_path, mismatches_count, first_mismatch);
+            valid = false;
+        }
+    }
+
+    uint32_t stored_checksum = byteswap32(layout.header->checksum);
+    uint32_t checksum = font_tag_checksum(tag_data, tag_size);
+    if(stored_checksum != checksum) {
+        fprintf(stderr, "%s has checksum %08X, but its data gives %08X\n", tag_path, stored_checksum, checksum);
+        valid = false;
+    }
+
+    return valid;
+}
+
+struct verify_list {
+    char **paths;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+static bool verify_list_add(struct verify_list *list, const char *path) {
+    if(list->count == list->capacity) {
+        uint32_t capacity = list->capacity ? list->capacity * 2 : 256;
+        char **paths = realloc(list->paths, capacity * sizeof(char *));
+        if(!paths) {
+            fprintf(stderr, "Could not allocate the list of tags\n");
+            return false;
+        }
+        list->paths = paths;
+        list->capacity = capacity;
+    }
+
+    if(!(list->paths[list->count] = strdup(path))) {
+        fprintf(stderr, "Could not allocate the list of tags\n");
+        return false;
+    }
+    list->count++;
+
+    return true;
+}
+
+static void verify_list_free(struct verify_list *list) {
+    for(uint32_t i = 0; i < list->count; i++) {
+        free(list->paths[i]);
+    }
+    free(list->paths);
+    *list = (struct verify_list){0};
+}
+
+// Add every .font file in a directory and the directories under it
+static bool verify_list_scan(struct verify_list *list, const char *dir_path) {
+    DIR *dir = opendir(dir_path);
+    if(!dir) {
+        fprintf(stderr, "Could not open directory %s\n", dir_path);
+        return false;
+    }
+
+    size_t dir_path_length = strlen(dir_path);
+    bool separator = dir_path_length != 0 && dir_path[dir_path_length - 1] != '/';
+    bool success = true;
+    struct dirent *entry;
+    while(success && (entry = readdir(dir)) != nullptr) {
+        const char *name = entry->d_name;
+
+        // Exclude "." and ".."
+        if(name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+
+        size_t name_length = strlen(name);
+        size_t path_size = dir_path_length + separator + name_length + 1;
+        char *path = malloc(path_size);
+        if(!path) {
+            fprintf(stderr, "Could not allocate path buffer\n");
+            success = false;
+            break;
+        }
+        snprintf(path, path_size, "%s%s%s", dir_path, separator ? "/" : "", name);
+
+        struct stat st;
+        if(LSTAT(path, &st) != 0) {
+            fprintf(stderr, "Could not stat %s\n", path);
+            success = false;
+        }
+        else if(S_ISDIR(st.st_mode)) {
+            success = verify_list_scan(list, path);
+        }
+        else if(name_length > 5 && strcmp(name + name_length - 5, ".font") == 0) {
+            success = verify_list_add(list, path);
+        }
+
+        free(path);
+    }
+
+    closedir(dir);
+
+    return success;
+}
+
+struct verify_context {
+    const struct verify_list *list;
+    atomic_uint_least32_t next_tag;
+    atomic_uint_least32_t bad_count;
+    atomic_uint_least64_t bytes_read;
+};
+
+// Each thread takes the next tag until there are none left, since tags can be very different sizes
+static bool verify_worker(void *context, uint32_t, uint32_t) {
+    struct verify_context *verify = context;
+    while(true) {
+        uint32_t t = atomic_fetch_add(&verify->next_tag, 1);
+        if(t >= verify->list->count) {
+            return true;
+        }
+
+        const char *path = verify->list->paths[t];
+        struct mapped_file file;
+        bool valid = mapped_file_open(&file, path) && verify_font_tag(path, file.data, file.size);
+        atomic_fetch_add_explicit(&verify->bytes_read, file.size, memory_order_relaxed);
+        mapped_file_close(&file);
+        if(!valid) {
+            atomic_fetch_add_explicit(&verify->bad_count, 1, memory_order_relaxed);
+        }
+    }
+}
+
+bool verify_font_tags(const char *const *paths, uint32_t paths_count, const struct verify_options *options) {
+    double start = monotonic_seconds();
+    struct verify_list list = {0};
+    bool success = true;
+    for(uint32_t i = 0; i < paths_count && success; i++) {
+        struct stat st;
+        if(stat(paths[i], &st) != 0) {
+            fprintf(stderr, "Could not find %s\n", paths[i]);
+            success = false;
+        }
+        else if(S_ISDIR(st.st_mode)) {
+            success = verify_list_scan(&list, paths[i]);
+        }
+        else {
+            success = verify_list_add(&list, paths[i]);
+        }
+    }
+
+    if(success && list.count == 0) {
+        fprintf(stderr, "No font tags were found\n");
+        success = false;
+    }
+
+    if(!success) {
+        verify_list_free(&list);
+        return false;
+    }
+
+    struct verify_context verify = { .list = &list };
+    unsigned jobs = options->jobs < list.count ? options->jobs : list.count;
+    success = parallel_for(jobs, jobs, verify_worker, &verify);
+
+    uint32_t bad_count = atomic_load(&verify.bad_count);
+    printf("%u of %u font tags are valid (%.1f MiB in %.2f seconds)\n", list.count - bad_count, list.count,
+           atomic_load(&verify.bytes_read) / (1024.0 * 1024.0), monotonic_seconds() - start);
+    verify_list_free(&list);
+
+    return success && bad_count == 0;
+}
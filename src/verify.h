@@ -0,0 +1,19 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct verify_options {
+    unsigned jobs; // number of tags checked at once
+};
+
+// Check everything split and the game rely on in a font tag: its header, the bounds of everything in it, that its
+// character tables find each character, that each character's pixels are in bounds, that no character is in it twice,
+// and that the checksum in its header matches. Every problem found is printed with tag_path.
+bool verify_font_tag(const char *tag_path, const uint8_t *tag_data, size_t tag_size);
+
+// Verify each font tag given, and every .font file in each directory given and the directories under it, then print
+// a summary. Returns false if any tag is bad or could not be read, or if there were no tags at all.
+bool verify_font_tags(const char *const *paths, uint32_t paths_count, const struct verify_options *options);
@@ -0,0 +1,65 @@
+// Font Slicer, by Aerocatia
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "character_tables.h"
+#include "workspace.h"
+
+void workspace_free(struct workspace *workspace) {
+    free(workspace->seen);
+    free(workspace->character_files);
+    free(workspace->selected);
+    free(workspace->characters);
+    glyph_set_free(&workspace->glyphs);
+    free(workspace->character_tables);
+    free(workspace->pixels_offsets);
+    free(workspace->pixel_windows[0]);
+    free(workspace->pixel_windows[1]);
+    free(workspace);
+}
+
+struct workspace *workspace_new(void) {
+    struct workspace *workspace = calloc(1, sizeof(struct workspace));
+    if(!workspace) {
+        fprintf(stderr, "Could not allocate workspace\n");
+        return nullptr;
+    }
+
+    workspace->seen = malloc((UINT16_MAX + 1) * sizeof(bool));
+    workspace->character_files = malloc((UINT16_MAX + 1) * sizeof(uint16_t));
+    workspace->selected = malloc((UINT16_MAX + 1) * sizeof(uint32_t));
+    workspace->characters = malloc((UINT16_MAX + 1) * sizeof(struct font_character));
+    workspace->character_tables = malloc(CHARACTER_TABLES_MAX_SIZE);
+    workspace->pixels_offsets = malloc((UINT16_MAX + 2) * sizeof(size_t));
+    if(!workspace->seen || !workspace->character_files || !workspace->selected || !workspace->characters || !workspace->character_tables || !workspace->pixels_offsets ||
+       !glyph_set_init(&workspace->glyphs, UINT16_MAX + 1)) {
+        fprintf(stderr, "Could not allocate workspace\n");
+        workspace_free(workspace);
+        return nullptr;
+    }
+
+    return workspace;
+}
+
+bool workspace_reserve_pixel_windows(struct workspace *workspace, size_t size) {
+    if(workspace->pixel_window_size >= size) {
+        return true;
+    }
+
+    for(int w = 0; w < 2; w++) {
+        free(workspace->pixel_windows[w]);
+        workspace->pixel_windows[w] = malloc(size);
+    }
+
+    if(!workspace->pixel_windows[0] || !workspace->pixel_windows[1]) {
+        fprintf(stderr, "Could not allocate %zu bytes for pixel windows\n", size * 2);
+        workspace->pixel_window_size = 0;
+        return false;
+    }
+
+    workspace->pixel_window_size = size;
+
+    return true;
+}
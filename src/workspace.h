@@ -0,0 +1,33 @@
+// Font Slicer, by Aerocatia
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "font.h"
+#include "glyph_set.h"
+#include "parallel.h"
+#include "stats.h"
+
+// Buffers big enough for any font tag. Batch workers keep one each and reuse it for every job.
+struct workspace {
+    bool *seen;
+    uint16_t *character_files;
+    uint32_t *selected;
+    struct font_character *characters;
+    struct glyph_set glyphs;
+    uint8_t *character_tables;
+    size_t *pixels_offsets;
+    uint8_t *pixel_windows[2];
+    size_t pixel_window_size;
+    struct parallel_task task;
+    struct stats *stats; // points at command_stats while a command with --stats runs, otherwise null
+    struct stats command_stats;
+};
+
+struct workspace *workspace_new(void);
+void workspace_free(struct workspace *workspace);
+
+// Grow the pixel windows if they are smaller than size
+bool workspace_reserve_pixel_windows(struct workspace *workspace, size_t size);